@@ -0,0 +1,190 @@
+#include <iostream>
+#include <fstream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <list>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+list<uint32_t> Read_BasisOp_BinaryRepresentation(string Basis_binary_filename);
+
+vector<double> LogE_AllSubsets(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r);
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+/******************************************************************************/
+/********************   READ a LIST of BASIS FILES   **************************/
+/******************************************************************************/
+// One basis filename per line; each basis file is written in the binary representation (see Read_BasisOp_BinaryRepresentation):
+vector<string> Read_Basis_Filenames(string list_filename)
+{
+  vector<string> Basis_filenames;
+  string line;
+
+  ifstream myfile (list_filename.c_str());
+  if (myfile.is_open())
+  {
+    while ( getline (myfile,line))
+      {  if (!line.empty() && line[0] != '#')  {  Basis_filenames.push_back(line);  }  }
+    myfile.close();
+  }
+  else cout << "Unable to open file \"" << list_filename << "\"" << endl;
+
+  return Basis_filenames;
+}
+
+/******************************************************************************/
+/*************   CHANGE of BASIS of the DATA for MANY BASES at once   *********/
+/******************************************************************************/
+// Kset_all[k] = histogram of the data in the basis Bases[k];
+// Operators shared by several bases are only evaluated once: for each observed state s, the parity of all the distinct
+// operators is computed in a single pass, and the transformed states of all the bases are assembled from these parities.
+
+vector<vector<pair<uint32_t, unsigned int>>> build_Kset_ManyBases(const vector<pair<uint32_t, unsigned int>> &Nset, const vector<list<uint32_t>> &Bases)
+{
+  // *** Distinct operators, and position of each operator of each basis in that list:
+  vector<uint32_t> Ops;
+  for (auto const& Basis : Bases)  {  Ops.insert(Ops.end(), Basis.begin(), Basis.end());  }
+  sort(Ops.begin(), Ops.end());
+  Ops.erase(unique(Ops.begin(), Ops.end()), Ops.end());
+
+  vector<vector<unsigned int>> Op_index(Bases.size());
+  for (unsigned int k=0; k<Bases.size(); k++)
+    for (auto const& Op : Bases[k])
+      {  Op_index[k].push_back(lower_bound(Ops.begin(), Ops.end(), Op) - Ops.begin());  }
+
+  // *** Single pass over the data:
+  vector<vector<pair<uint32_t, unsigned int>>> Kset_all(Bases.size(), vector<pair<uint32_t, unsigned int>>(Nset.size()));
+  vector<uint32_t> parity(Ops.size(), 0);
+
+  for (unsigned int i=0; i<Nset.size(); i++)
+  {
+    uint32_t s = Nset[i].first;
+    for (unsigned int j=0; j<Ops.size(); j++)  {  parity[j] = bitset<n>(Ops[j] & s).count() & 1;  }
+
+    for (unsigned int k=0; k<Bases.size(); k++)
+    {
+      uint32_t sig = 0;
+      for (unsigned int l=0; l<Op_index[k].size(); l++)  {  sig |= (parity[Op_index[k][l]] << l);  }
+      Kset_all[k][i] = make_pair(sig, Nset[i].second);
+    }
+  }
+
+  // *** Merge the states that are identical in the new basis (same format as build_Kset):
+  for (auto& Kset : Kset_all)
+  {
+    sort(Kset.begin(), Kset.end());
+    unsigned int K = 0;
+    for (unsigned int i=0; i<Kset.size(); i++)
+    {
+      if (K > 0 && Kset[K-1].first == Kset[i].first)  {  Kset[K-1].second += Kset[i].second;  }
+      else  {  Kset[K] = Kset[i];  K++;  }
+    }
+    Kset.resize(K);
+  }
+
+  return Kset_all;
+}
+
+/******************************************************************************/
+/*****************   BEST MCM for MANY CANDIDATE BASES   **********************/
+/******************************************************************************/
+// *** For each basis in Bases, search for the best MCM of rank r = Config.r (or of rank Bases[k].size() if smaller);
+// *** the data is transformed in all the bases in a single pass, and the searches are run in parallel on n_threads threads
+// *** (n_threads = 0: number of hardware threads).
+// *** A summary table, ranked by decreasing LogE of the best MCM, is printed in the file "BatchBases_Summary.dat" (if Config.print_files);
+// *** Basis_names[k] is used to identify the basis k in this file (e.g. its filename).
+// *** Returns, for each basis (in the same order as Bases), the LogE of the best MCM and the best MCM.
+
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_Batch_Bases(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, const vector<list<uint32_t>> &Bases, const vector<string> &Basis_names, const MCM_Search_Config &Config, unsigned int n_threads=0)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Search for the best MCM in " << Bases.size() << " bases.." << endl;
+
+  vector<vector<pair<uint32_t, unsigned int>>> Kset_all = build_Kset_ManyBases(Nset, Bases);
+  vector<pair<double, map<uint32_t, uint32_t>>> Results(Bases.size());
+
+  // *** Thread pool: each thread takes the next basis to process:
+  if (n_threads == 0)  {  n_threads = thread::hardware_concurrency();  }
+  if (n_threads == 0)  {  n_threads = 1;  }
+
+  atomic<unsigned int> next_basis(0);
+  vector<thread> Threads;
+
+  for (unsigned int t=0; t<n_threads; t++)
+  {
+    Threads.push_back(thread([&]()
+    {
+      for (unsigned int k = next_basis++; k < Bases.size(); k = next_basis++)
+      {
+        unsigned int r_k = min(r, (unsigned int) Bases[k].size());
+        double LogE_best = 0;
+        Results[k].second = MCM_SubsetDP(LogE_AllSubsets(Kset_all[k], N, r_k), r_k, &LogE_best);
+        Results[k].first = LogE_best - ((double) (N * (n-r_k))) * log(2.);     // contribution of the non-modeled spins
+      }
+    }));
+  }
+  for (auto& t : Threads)  {  t.join();  }
+
+  // *** Summary table, by decreasing LogE:
+  vector<unsigned int> Rank(Bases.size());
+  for (unsigned int k=0; k<Bases.size(); k++)  {  Rank[k] = k;  }
+  stable_sort(Rank.begin(), Rank.end(), [&](unsigned int k1, unsigned int k2) {  return Results[k1].first > Results[k2].first;  });
+
+  Output_File file_Summary;
+  if (Config.print_files)  {  file_Summary.open(Config.output_directory + "BatchBases_Summary.dat");  }
+  file_Summary << "# 1:Rank \t 2:Basis \t 3:LogE of the best MCM \t 4:Best MCM \t 5:Basis operators (integer representation)" << endl;
+
+  for (unsigned int i=0; i<Rank.size(); i++)
+  {
+    unsigned int k = Rank[i];
+    unsigned int r_k = min(r, (unsigned int) Bases[k].size());
+    file_Summary << (i+1) << " \t" << ((k < Basis_names.size()) ? Basis_names[k] : to_string(k)) << " \t" << Results[k].first << " \t" << Partition_to_String(Results[k].second, r_k) << " \t";
+    for (auto const& Op : Bases[k])  {  file_Summary << Op << " ";  }
+    file_Summary << endl;
+  }
+  file_Summary.close();
+
+  if (!Rank.empty())
+  {
+    out << "--> Best basis: " << ((Rank[0] < Basis_names.size()) ? Basis_names[Rank[0]] : to_string(Rank[0]));
+    out << " \t LogE = " << Results[Rank[0]].first << endl;
+  }
+  if (Config.print_files)  {  out << "--> Summary printed in the file '" << (Config.output_directory + "BatchBases_Summary.dat") << "'" << endl;  }
+  out << endl;
+
+  return Results;
+}
+
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_Batch_Bases(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, const vector<list<uint32_t>> &Bases, const vector<string> &Basis_names, unsigned int r=n, unsigned int n_threads=0)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_Batch_Bases(Nset, N, Bases, Basis_names, Config, n_threads);
+}
+
+// *** Same, with the list of bases given in the file `list_filename` (one basis filename per line, see Read_Basis_Filenames):
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_Batch_Bases(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, string list_filename, unsigned int r=n, unsigned int n_threads=0)
+{
+  vector<string> Basis_filenames = Read_Basis_Filenames(list_filename);
+
+  vector<list<uint32_t>> Bases;
+  for (auto const& filename : Basis_filenames)  {  Bases.push_back(Read_BasisOp_BinaryRepresentation(filename));  }
+
+  return MCM_Batch_Bases(Nset, N, Bases, Basis_filenames, r, n_threads);
+}
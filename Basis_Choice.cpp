@@ -3,6 +3,13 @@
 #include <sstream>
 #include <list>
 #include <bitset>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <new>         /* bad_alloc */
+
+#include <unistd.h>    /* sysconf */
 
 /********************************************************************/
 /**************************    CONSTANTS    *************************/
@@ -107,3 +114,133 @@ void PrintTerm_Basis(list<uint32_t> Basis_li)
   } cout << "##" << endl;
 }
 
+
+/******************************************************************************/
+/****************    CHECK that the OPERATORS are INDEPENDENT   ***************/
+/******************************************************************************/
+// Operators are independent if none of them is a product of the others, i.e. if their binary representations
+// are linearly independent vectors over GF(2) (where the product of two operators is the XOR of their representations).
+// Incremental Gaussian elimination: Pivot[i] = reduced operator with highest bit i (0 if none yet);
+// returns false if Op is a product of the operators already added (and doesn't add it), otherwise adds it and returns true.
+
+bool Add_Independent_Operator(vector<uint32_t> &Pivot, uint32_t Op)
+{
+  for (int i=n-1; i>=0 && Op != 0; i--)
+  {
+    if ( !((Op >> i) & 1) )  {  continue;  }
+    if (Pivot[i] == 0)  {  Pivot[i] = Op;  return true;  }
+    Op ^= Pivot[i];
+  }
+  return false;
+}
+
+bool Check_Independent_Operators(list<uint32_t> Basis_li)
+{
+  vector<uint32_t> Pivot(n, 0);
+  for (auto const& Op : Basis_li)
+    {  if (!Add_Independent_Operator(Pivot, Op))  {  return false;  }  }
+  return true;
+}
+
+/******************************************************************************/
+/*******************    SEARCH for the BEST BASIS    **************************/
+/******************************************************************************/
+// *** Statistics of all the 2^n - 1 spin operators, computed once from the histogram of the data:
+// ***     Op_Sum[Op] = sum over the datapoints of phi_Op(s) = +1 or -1 (parity of the spins of s in Op),
+// ***     obtained with a fast Walsh-Hadamard transform of the dense histogram (2^n values, O(n 2^n) operations).
+vector<int64_t> Operator_Statistics(const vector<pair<uint32_t, unsigned int>> &Nset)
+{
+  size_t Nstates = (1ULL << n);
+  vector<int64_t> Op_Sum(Nstates, 0);
+
+  for (auto const& it : Nset)  {  Op_Sum[(it).first] += (it).second;  }
+
+  for (size_t h = 1; h < Nstates; h <<= 1)
+    for (size_t i = 0; i < Nstates; i += (h << 1))
+      for (size_t j = i; j < i + h; j++)
+      {
+        int64_t x = Op_Sum[j], y = Op_Sum[j + h];
+        Op_Sum[j] = x + y;    Op_Sum[j + h] = x - y;
+      }
+
+  return Op_Sum;
+}
+
+// *** Entropy (in nats) of the operator Op, i.e. of the binary variable phi_Op(s):
+double Operator_Entropy(int64_t Op_Sum, unsigned int N)
+{
+  double p = (1. + ((double) Op_Sum) / N) / 2.;   // probability that phi_Op = +1
+  double H = 0;
+  if (p > 0)  {  H -= p * log(p);  }
+  if (p < 1)  {  H -= (1-p) * log(1-p);  }
+  return H;
+}
+
+// *** Best basis of m operators: set of m independent operators with the smallest sum of entropies,
+// *** i.e. the basis in which the data is the closest to an independent model (see Ref. [1]).
+// *** Greedy algorithm (exact for this problem): operators are taken by increasing entropy, and are kept if they are
+// *** independent from the operators already selected (incremental Gaussian elimination over GF(2)).
+// *** The basis is returned in the order of selection (the first operator has the smallest entropy),
+// *** and can directly be used with build_Kset().
+// *** The statistics and the sorted operators take Best_Basis_bytes_per_Op bytes for each of the 2^n operators:
+// *** for a larger n than allowed by Best_Basis_max_memory or by the physical memory of the computer
+// *** (or if the memory can't be allocated), returns an empty basis.
+
+const unsigned int Best_Basis_bytes_per_Op = sizeof(int64_t) + sizeof(uint32_t);
+const double Best_Basis_max_memory = 8e9;      // bytes
+
+list<uint32_t> Find_Best_Basis(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, unsigned int m=n, bool print_bool=false)
+{
+  cout << "--->> Search for the best basis.." << endl;
+
+  list<uint32_t> Basis_li;
+  double memory = (double) Best_Basis_bytes_per_Op * pow(2., n);
+  double max_memory = Best_Basis_max_memory;
+  long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGE_SIZE);
+  if (pages > 0 && page_size > 0)  {  max_memory = min(max_memory, (double) pages * page_size);  }
+
+  if (memory > max_memory)
+  {
+    cout << "--> Error: n = " << n << " is too large, the statistics of the 2^n operators would take ";
+    cout << memory / 1e9 << " GB (maximum: " << max_memory / 1e9 << " GB); no basis returned" << endl << endl;
+    return Basis_li;
+  }
+
+  vector<int64_t> Op_Sum;
+  vector<uint32_t> Ops;
+  try
+  {
+    Op_Sum = Operator_Statistics(Nset);
+    Ops.resize(Op_Sum.size() - 1);
+  }
+  catch (const bad_alloc &)
+  {
+    cout << "--> Error: not enough memory for the statistics of the 2^n operators (n = " << n << "); no basis returned" << endl << endl;
+    return Basis_li;
+  }
+
+  // *** Operators by increasing entropy, i.e. by decreasing |Op_Sum| (ties: smallest integer first):
+  for (size_t Op = 1; Op < Op_Sum.size(); Op++)  {  Ops[Op-1] = (uint32_t) Op;  }
+  stable_sort(Ops.begin(), Ops.end(), [&](uint32_t Op1, uint32_t Op2) {  return llabs(Op_Sum[Op1]) > llabs(Op_Sum[Op2]);  });
+
+  // *** Greedy selection of independent operators:
+  vector<uint32_t> Pivot(n, 0);
+  double H_tot = 0;
+
+  if (print_bool)  {  cout << "## 1:i \t 2:Op \t 3:Op_binary \t 4:<phi_Op> \t 5:Entropy" << endl;  }
+
+  for (size_t k=0; k<Ops.size() && Basis_li.size() < m; k++)
+  {
+    uint32_t Op = Ops[k];
+    if (Add_Independent_Operator(Pivot, Op))
+    {
+      Basis_li.push_back(Op);
+      H_tot += Operator_Entropy(Op_Sum[Op], N);
+      if (print_bool)  {  cout << "##\t " << Basis_li.size() << " \t " << Op << " \t " << bitset<n>(Op) << " \t " << ((double) Op_Sum[Op]) / N << " \t " << Operator_Entropy(Op_Sum[Op], N) << endl;  }
+    }
+  }
+
+  cout << "--> Sum of the entropies of the " << Basis_li.size() << " basis operators: " << H_tot << " nats" << endl << endl;
+
+  return Basis_li;
+}
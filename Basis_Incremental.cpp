@@ -0,0 +1,84 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <list>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#include "data.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+uint32_t transform_mu_basis(uint32_t mu, list<uint32_t> basis);
+
+double LogE_ICC_Sorted(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC);
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best);
+
+/******************************************************************************/
+/*******************   KEY of an ICC: its set of OPERATORS   ******************/
+/******************************************************************************/
+// The histogram of an ICC only depends on the set of basis operators it contains (up to a relabelling of its states),
+// and not on the position of these operators in the basis: an ICC is therefore identified by its (sorted) set of operators,
+// written in the original basis of the data.
+vector<uint32_t> ICC_Operators(const vector<uint32_t> &Basis_vec, uint32_t Ai)
+{
+  vector<uint32_t> Ops;
+  for (unsigned int i=0; Ai != 0; i++, Ai >>= 1)
+    {  if (Ai & 1)  {  Ops.push_back(Basis_vec[i]);  }  }
+  sort(Ops.begin(), Ops.end());
+  return Ops;
+}
+
+/******************************************************************************/
+/**************   INCREMENTAL SEARCH after a CHANGE of the BASIS   ************/
+/******************************************************************************/
+// *** Best MCM of rank r in the basis `Basis`, for the dataset Nset (written in the original basis).
+// *** LogE_cache contains the LogE of the ICCs already computed for this dataset, with any previous basis:
+// ***    key = set of operators of the ICC (see ICC_Operators) --> value = LogE of the ICC.
+// *** Only the ICCs that are not in the cache are computed (and added to the cache):
+// *** e.g. if a single operator of the basis was swapped or appended since the last call,
+// *** only the ICCs that contain this operator are computed.
+// *** The cache must only be used with a single dataset. Nothing is printed.
+
+map<uint32_t, uint32_t> MCM_Basis_Incremental(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, list<uint32_t> Basis, map<vector<uint32_t>, double> &LogE_cache, double *LogE_best, unsigned int r=n)
+{
+  vector<uint32_t> Basis_vec(Basis.begin(), Basis.end());
+  if (r > Basis_vec.size())  {  r = Basis_vec.size();  }
+  Basis_vec.resize(r);
+
+  uint32_t Nsub = (1UL << r);
+  vector<double> LogE_table(Nsub, 0);
+
+  // *** Data in the new basis (computed only if some ICCs are missing from the cache):
+  vector<pair<uint32_t, unsigned int>> Kset, Kset_ICC;
+  list<uint32_t> Basis_r(Basis_vec.begin(), Basis_vec.end());
+
+  map<vector<uint32_t>, double>::iterator it;
+
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+  {
+    vector<uint32_t> Ops = ICC_Operators(Basis_vec, Ai);
+    it = LogE_cache.find(Ops);
+
+    if (it == LogE_cache.end())
+    {
+      if (Kset.empty())
+      {
+        Kset.resize(Nset.size());
+        for (unsigned int i=0; i<Nset.size(); i++)
+          {  Kset[i] = make_pair(transform_mu_basis(Nset[i].first, Basis_r), Nset[i].second);  }
+      }
+      it = LogE_cache.insert(make_pair(Ops, LogE_ICC_Sorted(Kset, Ai, N, Kset_ICC))).first;
+    }
+    LogE_table[Ai] = it->second;
+  }
+
+  map<uint32_t, uint32_t> Partition = MCM_SubsetDP(LogE_table, r, LogE_best);
+  (*LogE_best) -= ((double) (N * (n-r))) * log(2.);     // contribution of the non-modeled spins
+
+  return Partition;
+}
@@ -0,0 +1,247 @@
+// To compile (in the folder BatchRunner): g++ -std=c++11 -O3 -pthread -I.. -o batch_runner.out batch_runner.cpp ../Data_Manipulation.cpp ../LogL_LogE.cpp ../Complexity.cpp ../Basis_Choice.cpp ../MCM_info.cpp ../P_s.cpp ../Best_MCM.cpp ../Best_MCM_SubsetDP.cpp ../CrossValidation.cpp ../Bootstrap.cpp ../Streaming.cpp ../Basis_Incremental.cpp ../Basis_Batch.cpp ../Best_MCM_Anytime.cpp ../Best_MCM_Annealing.cpp ../Best_MCM_Constrained.cpp ../Best_MCM_MultiCriteria.cpp ../Best_MCM_PriorGrid.cpp ../ICC_PersistentCache.cpp ../Best_MCM_Specialized.cpp ../Progress.cpp ../Profiling.cpp ../MCM_CAPI.cpp ../MCM_Engine.cpp ../ICC_Projection.cpp ../Tiered_Cache.cpp ../Output.cpp
+// To run (from the main folder, where the folders INPUT and OUTPUT are): ./BatchRunner/batch_runner.out BatchRunner/Manifest_example.txt --threads 4
+//
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>     // strtod, strtoul
+#include <cctype>      // isdigit
+#include <list>
+#include <map>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <sys/stat.h>   // mkdir
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "library.h"
+
+/******************************************************************************/
+/*****************************   MANIFEST   ***********************************/
+/******************************************************************************/
+// One job per line (the lines starting with '#' are ignored):
+// ***     datafile   basis   r   mode   [name]
+// with:
+// ***   - datafile:  dataset in the same format as the main program (n spins per line, n is set in data.h or with -DMCM_N=...);
+// ***   - basis:     file with the basis operators in the binary representation (see Read_BasisOp_BinaryRepresentation),
+// ***                or "original" for the original basis of the data, or "best" for the basis found by Find_Best_Basis;
+// ***   - r:         rank of the MCMs (the MCMs are built on the r first operators of the basis);
+// ***   - mode:      "exact" (best MCM of rank r, same result as Versions 1 and 2, with MCM_GivenRank_r_SubsetDP),
+// ***                or "anytime:<seconds>" (MCM_Anytime with this time budget; the job fails if <seconds> is not a number >= 0);
+// ***   - name:      (optional) name of the output subfolder of the job, by default "job<line>_<datafile name>".
+
+struct Batch_Job {
+    string datafile, basis, mode, name;
+    unsigned int r;
+    double time_budget;         // for the mode "anytime"
+    // *** Results:
+    unsigned int N;
+    double LogE, time;
+    string partition, status;
+};
+
+string File_Stem(const string &filename)
+{
+  size_t start = filename.find_last_of('/');
+  start = (start == string::npos) ? 0 : start+1;
+  size_t end = filename.find_last_of('.');
+  if (end == string::npos || end < start)  {  end = filename.size();  }
+  return filename.substr(start, end - start);
+}
+
+vector<Batch_Job> Read_Manifest(string manifest_filename)
+{
+  vector<Batch_Job> Jobs;
+  string line;
+  unsigned int line_number = 0;
+
+  ifstream myfile (manifest_filename.c_str());
+  if (!myfile.is_open())  {  cout << "Unable to open file \"" << manifest_filename << "\"" << endl;  return Jobs;  }
+
+  while (getline(myfile, line))
+  {
+    line_number++;
+    if (line.empty() || line[0] == '#')  {  continue;  }
+
+    Batch_Job Job = {"", "", "", "", 0, 0, 0, 0, 0, "", "waiting"};
+    stringstream ss(line);
+    if (!(ss >> Job.datafile >> Job.basis >> Job.r >> Job.mode))
+      {  if (!Job.datafile.empty())  {  cout << "Line " << line_number << " of the manifest is incomplete: skipped" << endl;  }  continue;  }
+    if (!(ss >> Job.name))  {  Job.name = "job" + to_string(line_number) + "_" + File_Stem(Job.datafile);  }
+
+    if (Job.mode.compare(0, 8, "anytime:") == 0)       // a time budget that is not a number makes the job fail (see Run_Job)
+    {
+      const char *budget = Job.mode.c_str() + 8;
+      char *end = NULL;
+      Job.time_budget = strtod(budget, &end);
+      if (end == budget || *end != '\0' || !(Job.time_budget >= 0))  {  Job.status = "error: invalid time budget \"" + Job.mode + "\"";  }
+      Job.mode = "anytime";
+    }
+    else if (Job.mode == "anytime")  {  Job.time_budget = 10;  }
+    Jobs.push_back(Job);
+  }
+  myfile.close();
+
+  return Jobs;
+}
+
+/******************************************************************************/
+/******************************   ONE JOB   ***********************************/
+/******************************************************************************/
+// *** The results of the job are printed in the subfolder OUTPUT_directory + Job.name:
+// ***   - "BestMCM.dat": the basis, the best MCM and its LogE;
+// ***   - the files printed by PrintFile_StateProbabilites_OriginalBasis (if print_Ps = true).
+void Run_Job(Batch_Job &Job, bool print_Ps)
+{
+  auto start = chrono::steady_clock::now();
+  if (Job.status != "waiting")  {  return;  }      // error found when reading the manifest
+  if (Job.mode != "exact" && Job.mode != "anytime")  {  Job.status = "error: unknown mode \"" + Job.mode + "\"";  return;  }
+
+  vector<pair<uint32_t, unsigned int>> Nset = read_datafile(&Job.N, Job.datafile);
+  if (Job.N == 0)  {  Job.status = "error: cannot read the datafile";  return;  }
+
+  list<uint32_t> Basis;
+  if (Job.basis == "original")  {  Basis = Original_Basis();  }
+  else if (Job.basis == "best")  {  Basis = Find_Best_Basis(Nset, Job.N);  }
+  else  {  Basis = Read_BasisOp_BinaryRepresentation(Job.basis);  }
+
+  if (Basis.empty() || !Check_Independent_Operators(Basis))  {  Job.status = "error: invalid basis";  return;  }
+  if (Job.r < 1 || Job.r > Basis.size())  {  Job.status = "error: r must be between 1 and the number of basis operators";  return;  }
+
+  vector<pair<uint32_t, unsigned int>> Kset = build_Kset(Nset, Basis, false);
+
+  map<uint32_t, uint32_t> Partition;
+  if (Job.mode == "exact")  {  Partition = MCM_GivenRank_r_SubsetDP(Kset, Job.N, &Job.LogE, Job.r);  }
+  else if (Job.mode == "anytime")
+  {
+    double LogE_bound = 0;
+    Partition = MCM_Anytime(Kset, Job.N, &Job.LogE, &LogE_bound, Job.time_budget, Job.r);
+  }
+  Job.partition = Partition_to_String(Partition, Job.r);
+
+  // *** Output files of the job:
+  string folder = OUTPUT_directory + Job.name;
+  mkdir(folder.c_str(), 0755);
+
+  Output_File file_Best(folder + "/BestMCM.dat");
+  file_Best << "## Datafile: " << Job.datafile << ", N = " << Job.N << endl;
+  file_Best << "## Basis (" << Job.basis << "), integer representation of the operators: ";
+  for (auto const& Op : Basis)  {  file_Best << Op << " ";  }
+  file_Best << endl << "## Search: " << Job.mode << ", rank r = " << Job.r << endl;
+  file_Best << "## Best MCM (the first operator of the basis corresponds to the bit the most on the right):" << endl;
+  file_Best << Job.partition << " \t LogE = " << Job.LogE << endl;
+  file_Best.close();
+
+  if (print_Ps)  {  PrintFile_StateProbabilites_OriginalBasis(Nset, Basis, Partition, Job.N, Job.name + "/Result");  }
+
+  Job.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  Job.status = "ok";
+}
+
+/******************************************************************************/
+/******************************   SUMMARY   ***********************************/
+/******************************************************************************/
+void Print_Summary(const vector<Batch_Job> &Jobs, string filename)
+{
+  Output_File file(filename);
+  file << "# 1:Job \t 2:Datafile \t 3:Basis \t 4:r \t 5:Mode \t 6:N \t 7:LogE of the best MCM \t 8:Best MCM \t 9:Time (s) \t 10:Status" << endl;
+  file.precision(10);
+  for (auto const& Job : Jobs)
+  {
+    file << Job.name << " \t" << Job.datafile << " \t" << Job.basis << " \t" << Job.r << " \t" << Job.mode << " \t" << Job.N << " \t";
+    if (Job.status == "ok")  {  file << Job.LogE << " \t" << Job.partition << " \t" << Job.time;  }
+    else  {  file << "- \t- \t-";  }
+    file << " \t" << Job.status << endl;
+  }
+  file.close();
+}
+
+/******************************************************************************/
+/******************************   MAIN   **************************************/
+/******************************************************************************/
+// *** The messages printed by the functions of the library are not printed during the jobs (the jobs run in parallel):
+struct Null_Buffer : public streambuf {
+    int overflow(int c) {  return c;  }
+};
+
+// Options:
+// ***   --threads 0               number of threads (0: number of hardware threads);
+// ***   --summary OUTPUT/Batch_Summary.dat     summary of all the jobs (one line per job, in the order of the manifest);
+// ***   --no_Ps                   do not print the state probabilities P(s) and P(k) of each job (only "BestMCM.dat").
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)  {  cout << "Usage: " << argv[0] << " manifest_file [--threads 0] [--summary " << OUTPUT_directory << "Batch_Summary.dat] [--no_Ps]" << endl;  return 1;  }
+
+  string manifest_filename = argv[1], summary_filename = OUTPUT_directory + "Batch_Summary.dat";
+  unsigned int n_threads = 0;
+  bool print_Ps = true;
+
+  for (int i=2; i<argc; i++)
+  {
+    string opt = argv[i];
+    if (opt == "--threads" && i+1 < argc)
+    {
+      char *end = NULL;
+      const char *value = argv[++i];
+      n_threads = strtoul(value, &end, 10);
+      if (!isdigit((unsigned char) value[0]) || *end != '\0')  {  cout << "Invalid number of threads: " << value << endl;  return 1;  }
+    }
+    else if (opt == "--summary" && i+1 < argc)  {  summary_filename = argv[++i];  }
+    else if (opt == "--no_Ps")  {  print_Ps = false;  }
+    else  {  cout << "Unknown option: " << opt << endl;  return 1;  }
+  }
+
+  vector<Batch_Job> Jobs = Read_Manifest(manifest_filename);
+  if (n_threads == 0)  {  n_threads = thread::hardware_concurrency();  }
+  if (n_threads == 0)  {  n_threads = 1;  }
+
+  Set_Progress_Report(0);
+  mkdir(OUTPUT_directory.c_str(), 0755);
+
+  cout << "--->> " << Jobs.size() << " jobs on " << n_threads << " threads (n = " << n << " spins)" << endl << endl;
+
+  // *** Thread pool: each thread takes the next job of the manifest:
+  Null_Buffer null_buffer;
+  streambuf *cout_buffer = cout.rdbuf();
+  ostream out(cout_buffer);
+  mutex out_mutex;
+
+  atomic<unsigned int> next_job(0), n_done(0);
+  vector<thread> Threads;
+  auto start = chrono::steady_clock::now();
+
+  cout.rdbuf(&null_buffer);
+  for (unsigned int t=0; t<n_threads; t++)
+  {
+    Threads.push_back(thread([&]()
+    {
+      for (unsigned int k = next_job++; k < Jobs.size(); k = next_job++)
+      {
+        try  {  Run_Job(Jobs[k], print_Ps);  }
+        catch (exception &e)  {  Jobs[k].status = string("error: ") + e.what();  }
+
+        lock_guard<mutex> lock(out_mutex);
+        out << "[" << ++n_done << "/" << Jobs.size() << "] " << Jobs[k].name << ": \t";
+        if (Jobs[k].status == "ok")  {  out << "Best MCM = " << Jobs[k].partition << " \t LogE = " << Jobs[k].LogE << endl;  }
+        else  {  out << Jobs[k].status << endl;  }
+      }
+    }));
+  }
+  for (auto& t : Threads)  {  t.join();  }
+  cout.rdbuf(cout_buffer);
+
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  Print_Summary(Jobs, summary_filename);
+
+  cout << endl << "--> " << Jobs.size() << " jobs in " << elapsed.count() << "s (" << Jobs.size() / max(elapsed.count(), 1e-9) << " jobs/s)" << endl;
+  cout << "--> Summary printed in the file '" << summary_filename << "'" << endl;
+
+  return 0;
+}
@@ -0,0 +1,361 @@
+// To compile (in the folder Benchmark): g++ -std=c++11 -O3 -pthread -DMCM_N=16 -I.. -o benchmark.out benchmark.cpp ../Data_Manipulation.cpp ../LogL_LogE.cpp ../Complexity.cpp ../Basis_Choice.cpp ../MCM_info.cpp ../P_s.cpp ../Best_MCM.cpp ../Best_MCM_SubsetDP.cpp ../CrossValidation.cpp ../Bootstrap.cpp ../Streaming.cpp ../Basis_Incremental.cpp ../Basis_Batch.cpp ../Best_MCM_Anytime.cpp ../Best_MCM_Annealing.cpp ../Best_MCM_Constrained.cpp ../Best_MCM_MultiCriteria.cpp ../Best_MCM_PriorGrid.cpp ../ICC_PersistentCache.cpp ../Best_MCM_Specialized.cpp ../Progress.cpp ../Profiling.cpp ../MCM_CAPI.cpp ../MCM_Engine.cpp ../ICC_Projection.cpp ../Tiered_Cache.cpp ../Output.cpp
+// To run: ./benchmark.out --r 8,10,12,14,16 --N 1000,10000,100000,1000000   (see the options below; results in OUTPUT/Benchmark.csv and OUTPUT/Benchmark.json)
+//
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+#include <cmath>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <sys/stat.h>   // mkdir
+
+using namespace std;
+
+#include "data.h"
+#include "library.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+double LogE_ICC(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai, unsigned int N);
+
+/******************************************************************************/
+/***************************   SYNTHETIC MCM   ********************************/
+/******************************************************************************/
+// Planted MCM on the r first spins (s1 to sr); the n-r other spins are not modeled (i.e. independent and uniform):
+// ***   - the r spins are shuffled and split into parts of random sizes between 1 and max_part_size;
+// ***   - in each part of m spins, only min(n_states, 2^m) states have a non-zero probability (chosen at random),
+// ***     so that the spins of a part are strongly dependent, and the parts are independent.
+// The data is written in the original basis, so that the planted partition is a partition of the r first operators of Original_Basis().
+
+struct Synthetic_MCM {
+    unsigned int r;
+    vector<uint32_t> Parts;                               // Parts[k] = spins in the part k
+    vector<vector<pair<uint32_t, double>>> States;        // States[k] = (state of the part k, cumulative probability)
+};
+
+// *** Spread the m lowest bits of x on the bits of `mask` (from the lowest to the highest):
+uint32_t Spread_Bits(uint32_t x, uint32_t mask)
+{
+  uint32_t state = 0;
+  for (uint32_t bit = 1; mask != 0; bit <<= 1)
+  {
+    uint32_t low = mask & (~mask + 1);   // lowest bit of mask
+    if (x & bit)  {  state |= low;  }
+    mask ^= low;
+  }
+  return state;
+}
+
+Synthetic_MCM Planted_MCM(unsigned int r, unsigned int max_part_size, unsigned int n_states, mt19937 &gen)
+{
+  Synthetic_MCM M;
+  M.r = r;
+
+  vector<unsigned int> spins(r);
+  for (unsigned int i=0; i<r; i++)  {  spins[i] = i;  }
+  shuffle(spins.begin(), spins.end(), gen);
+
+  uniform_int_distribution<unsigned int> part_size(1, max_part_size);
+  uniform_real_distribution<double> weight(0.2, 1.);
+
+  for (unsigned int i=0; i<r; )
+  {
+    unsigned int m = min(part_size(gen), r-i);
+    uint32_t Ai = 0;
+    for (unsigned int j=0; j<m; j++, i++)  {  Ai |= (1UL << spins[i]);  }
+
+    // *** support of the part:
+    uint32_t n_all = (1UL << m);
+    vector<uint32_t> x(n_all);
+    for (uint32_t s=0; s<n_all; s++)  {  x[s] = s;  }
+    shuffle(x.begin(), x.end(), gen);
+    x.resize(min((uint32_t) n_states, n_all));
+
+    vector<pair<uint32_t, double>> States;
+    double total = 0;
+    for (auto const& s : x)  {  total += weight(gen);  States.push_back(make_pair(Spread_Bits(s, Ai), total));  }
+    for (auto& st : States)  {  st.second /= total;  }
+
+    M.Parts.push_back(Ai);
+    M.States.push_back(States);
+  }
+  return M;
+}
+
+// *** One datapoint sampled from the planted MCM:
+uint32_t Sample_State(const Synthetic_MCM &M, mt19937 &gen)
+{
+  uniform_real_distribution<double> u(0., 1.);
+  uint32_t state = 0;
+
+  for (unsigned int k=0; k<M.Parts.size(); k++)
+  {
+    double x = u(gen);
+    const vector<pair<uint32_t, double>> &States = M.States[k];
+    unsigned int s = 0;
+    while (s+1 < States.size() && States[s].second < x)  {  s++;  }
+    state |= States[s].first;
+  }
+
+  uint32_t mask_rest = (uint32_t) (((1ULL << n) - 1) & ~((1ULL << M.r) - 1));   // non-modeled spins
+  return state | (gen() & mask_rest);
+}
+
+// *** Write N datapoints in a file with the same format as the input files (one state of n spins per line):
+void Write_Synthetic_Datafile(const Synthetic_MCM &M, unsigned int N, mt19937 &gen, string filename)
+{
+  fstream file(filename.c_str(), ios::out);
+  for (unsigned int i=0; i<N; i++)  {  file << bitset<n>(Sample_State(M, gen)).to_string() << '\n';  }
+  file.close();
+}
+
+// *** Same, directly stored as an Nset (as returned by read_datafile):
+vector<pair<uint32_t, unsigned int>> Synthetic_Nset(const Synthetic_MCM &M, unsigned int N, mt19937 &gen)
+{
+  map<uint32_t, unsigned int> Nset_map;
+  for (unsigned int i=0; i<N; i++)  {  Nset_map[Sample_State(M, gen)] += 1;  }
+
+  vector<pair<uint32_t, unsigned int>> Nset(Nset_map.size());
+  unsigned int i = 0;
+  for (auto const& it : Nset_map)  {  Nset[i++] = it;  }
+  return Nset;
+}
+
+/******************************************************************************/
+/******************************   TOOLS   *************************************/
+/******************************************************************************/
+// *** The prints of the functions that are timed are discarded:
+struct Null_Buffer : public streambuf {
+    int overflow(int c)  {  return c;  }
+};
+
+// *** Same set of parts:
+bool Same_Partition(const map<uint32_t, uint32_t> &P1, const vector<uint32_t> &P2)
+{
+  set<uint32_t> S1, S2(P2.begin(), P2.end());
+  for (auto const& Part : P1)  {  S1.insert(Part.second);  }
+  return S1 == S2;
+}
+
+vector<double> Read_List(const string &arg)
+{
+  vector<double> List;
+  stringstream ss(arg);
+  string item;
+  while (getline(ss, item, ','))  {  List.push_back(stod(item));  }
+  return List;
+}
+
+/******************************************************************************/
+/****************************   RESULTS   *************************************/
+/******************************************************************************/
+struct Benchmark_Record {
+    unsigned int r, N, n_states, max_part_size, K;
+    string step, status;
+    double time, LogE, LogE_planted;
+    int recovered;        // -1 if not applicable
+    string partition, planted;
+};
+
+void Print_Records_CSV(const vector<Benchmark_Record> &Records, string filename)
+{
+  fstream file(filename.c_str(), ios::out);
+  file << "n,r,N,n_states,max_part_size,K,step,status,time_s,LogE,LogE_planted,recovered,partition,planted" << endl;
+  file.precision(10);
+  for (auto const& R : Records)
+  {
+    file << n << "," << R.r << "," << R.N << "," << R.n_states << "," << R.max_part_size << "," << R.K << "," << R.step << "," << R.status << ",";
+    if (R.status == "ok")  {  file << R.time;  }
+    file << ",";
+    if (R.recovered >= 0)  {  file << R.LogE << "," << R.LogE_planted << "," << R.recovered << "," << R.partition << "," << R.planted;  }
+    else  {  file << ",,,,";  }
+    file << endl;
+  }
+  file.close();
+}
+
+void Print_Records_JSON(const vector<Benchmark_Record> &Records, string filename)
+{
+  fstream file(filename.c_str(), ios::out);
+  file.precision(10);
+  file << "[" << endl;
+  for (unsigned int i=0; i<Records.size(); i++)
+  {
+    const Benchmark_Record &R = Records[i];
+    file << "  {\"n\": " << n << ", \"r\": " << R.r << ", \"N\": " << R.N << ", \"n_states\": " << R.n_states << ", \"max_part_size\": " << R.max_part_size;
+    file << ", \"K\": " << R.K << ", \"step\": \"" << R.step << "\", \"status\": \"" << R.status << "\"";
+    if (R.status == "ok")  {  file << ", \"time_s\": " << R.time;  }
+    if (R.recovered >= 0)
+    {
+      file << ", \"LogE\": " << R.LogE << ", \"LogE_planted\": " << R.LogE_planted << ", \"recovered\": " << (R.recovered ? "true" : "false");
+      file << ", \"partition\": \"" << R.partition << "\", \"planted\": \"" << R.planted << "\"";
+    }
+    file << "}" << ((i+1 < Records.size()) ? "," : "") << endl;
+  }
+  file << "]" << endl;
+  file.close();
+}
+
+/******************************************************************************/
+/******************************   MAIN   **************************************/
+/******************************************************************************/
+// Options (lists are separated by commas):
+// ***   --r 8,10,12,14,16         ranks of the planted MCMs (and of the searches); only the values r <= n are used (n is set with -DMCM_N=...);
+// ***   --N 1000,10000,...        number of datapoints (up to 4 294 967 295);
+// ***   --states 8                maximum number of states with a non-zero probability in each part of the planted MCM;
+// ***   --max_part 4              maximum number of spins in each part of the planted MCM;
+// ***   --max_cost 1e9            a search is skipped if its estimated cost is larger (in number of states of Kset visited, see below);
+// ***   --time_budget 10          time budget (in seconds) of MCM_Anytime;
+// ***   --N_file_max 1000000      the datasets with more datapoints are not written in a file (read_datafile is then not timed);
+// ***   --seed 1                  seed of the random generator;
+// ***   --out OUTPUT/Benchmark    prefix of the result files (.csv and .json).
+
+int main(int argc, char *argv[])
+{
+  vector<double> R_list = {8, 10, 12, 14, 16}, N_list = {1e3, 1e4, 1e5, 1e6};
+  unsigned int n_states = 8, max_part_size = 4, seed = 1;
+  double max_cost = 1e9, time_budget = 10, N_file_max = 1e6;
+  string out = OUTPUT_directory + "Benchmark";
+
+  for (int i=1; i+1<argc; i+=2)
+  {
+    string opt = argv[i], val = argv[i+1];
+    if (opt == "--r")  {  R_list = Read_List(val);  }
+    else if (opt == "--N")  {  N_list = Read_List(val);  }
+    else if (opt == "--states")  {  n_states = stoul(val);  }
+    else if (opt == "--max_part")  {  max_part_size = stoul(val);  }
+    else if (opt == "--max_cost")  {  max_cost = stod(val);  }
+    else if (opt == "--time_budget")  {  time_budget = stod(val);  }
+    else if (opt == "--N_file_max")  {  N_file_max = stod(val);  }
+    else if (opt == "--seed")  {  seed = stoul(val);  }
+    else if (opt == "--out")  {  out = val;  }
+    else  {  cout << "Unknown option: " << opt << endl;  return 1;  }
+  }
+
+  Set_Progress_Report(0);     // no progress report during the timed searches
+  mkdir(OUTPUT_directory.c_str(), 0755);
+  string datafile = OUTPUT_directory + "Benchmark_Data.dat";
+
+  cout << "--->> Benchmark for n = " << n << " spins; results in the files '" << out << ".csv' and '" << out << ".json'" << endl << endl;
+
+  vector<Benchmark_Record> Records;
+  mt19937 gen(seed);
+  Null_Buffer null_buffer;
+  streambuf *cout_buffer = cout.rdbuf();
+
+  for (auto const& r_d : R_list)
+  {
+    unsigned int r = (unsigned int) r_d;
+    if (r < 1 || r > n)  {  cout << "r = " << r << " > n = " << n << ": skipped (compile with -DMCM_N=" << r << " or larger)" << endl;  continue;  }
+
+    Synthetic_MCM M = Planted_MCM(r, max_part_size, n_states, gen);
+    map<uint32_t, uint32_t> Planted_map;
+    for (unsigned int k=0; k<M.Parts.size(); k++)  {  Planted_map[k] = M.Parts[k];  }
+    string planted = Partition_to_String(Planted_map, r);
+
+    for (auto const& N_d : N_list)
+    {
+      unsigned int N = (unsigned int) N_d, N_read = 0;
+      Benchmark_Record Rec = {r, N, n_states, max_part_size, 0, "", "ok", 0, 0, 0, -1, "", planted};
+      cout << "r = " << r << ", N = " << N << ", planted MCM = " << planted << ":" << endl;
+
+      // *** Data:
+      vector<pair<uint32_t, unsigned int>> Nset;
+      if (N_d <= N_file_max)
+      {
+        Write_Synthetic_Datafile(M, N, gen, datafile);
+        cout.rdbuf(&null_buffer);
+        auto start = chrono::steady_clock::now();
+        Nset = read_datafile(&N_read, datafile);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        cout.rdbuf(cout_buffer);
+        Rec.step = "read_datafile";  Rec.time = elapsed.count();
+      }
+      else
+      {
+        Nset = Synthetic_Nset(M, N, gen);
+        Rec.step = "read_datafile";  Rec.status = "skipped";
+      }
+      Records.push_back(Rec);
+
+      cout.rdbuf(&null_buffer);
+      auto start = chrono::steady_clock::now();
+      vector<pair<uint32_t, unsigned int>> Kset = build_Kset(Nset, Original_Basis(), false);
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      cout.rdbuf(cout_buffer);
+      Rec.K = Kset.size();  Rec.step = "build_Kset";  Rec.status = "ok";  Rec.time = elapsed.count();
+      Records.push_back(Rec);
+
+      start = chrono::steady_clock::now();
+      double LogE_CM = LogE_ICC(Kset, (1UL << r) - 1, N);
+      elapsed = chrono::steady_clock::now() - start;
+      Rec.step = "LogE_ICC";  Rec.time = elapsed.count();
+      Records.push_back(Rec);
+      cout << "\t K = " << Kset.size() << " states, LogE of the complete model = " << LogE_CM << endl;
+
+      Rec.LogE_planted = LogE_MCM(Kset, Planted_map, N);
+
+      // *** Searches, with their estimated cost (number of states of Kset visited):
+      double K = Kset.size(), Bell_r = Bell_number(r), Bell_r1 = Bell_number(r+1), two_r = pow(2., r);
+      vector<pair<string, double>> Searches = {
+          {"MCM_GivenRank_r", Bell_r * K},
+          {"MCM_GivenRank_r_Specialized", two_r * K + Bell_r * r},
+          {"MCM_AllRank_SmallerThan_r_Ordered", Bell_r1 * K},
+          {"MCM_AllRank_SmallerThan_r_nonOrdered", Bell_r1 * K},
+          {"MCM_GivenRank_r_SubsetDP", two_r * K + pow(3., r)},
+          {"MCM_Anytime", 0},
+          {"MCM_GivenRank_r_Annealing", two_r * K} };
+
+      for (auto const& Search : Searches)
+      {
+        Rec.step = Search.first;
+        if (Search.second > max_cost)
+        {
+          Rec.status = "skipped";  Rec.recovered = -1;
+          Records.push_back(Rec);
+          cout << "\t " << Search.first << ": skipped (estimated cost " << Search.second << " > " << max_cost << ")" << endl;
+          continue;
+        }
+
+        double LogE = 0, LogE_bound = 0;
+        map<uint32_t, uint32_t> Partition;
+
+        cout.rdbuf(&null_buffer);
+        start = chrono::steady_clock::now();
+        if (Search.first == "MCM_GivenRank_r")  {  Partition = MCM_GivenRank_r(Kset, N, &LogE, r, false);  }
+        else if (Search.first == "MCM_GivenRank_r_Specialized")  {  Partition = MCM_GivenRank_r_Specialized(Kset, N, &LogE, r, false);  }
+        else if (Search.first == "MCM_AllRank_SmallerThan_r_Ordered")  {  Partition = MCM_AllRank_SmallerThan_r_Ordered(Kset, N, &LogE, r, false);  }
+        else if (Search.first == "MCM_AllRank_SmallerThan_r_nonOrdered")  {  Partition = MCM_AllRank_SmallerThan_r_nonOrdered(Kset, N, &LogE, r, false);  }
+        else if (Search.first == "MCM_GivenRank_r_SubsetDP")  {  Partition = MCM_GivenRank_r_SubsetDP(Kset, N, &LogE, r);  }
+        else if (Search.first == "MCM_Anytime")  {  Partition = MCM_Anytime(Kset, N, &LogE, &LogE_bound, time_budget, r);  }
+        else if (Search.first == "MCM_GivenRank_r_Annealing")  {  Partition = MCM_GivenRank_r_Annealing(Kset, N, &LogE, r);  }
+        elapsed = chrono::steady_clock::now() - start;
+        cout.rdbuf(cout_buffer);
+
+        Partition.erase((uint32_t) -1);   // operators that are not in the MCM (versions 2 and 3), printed as "x"
+
+        Rec.status = "ok";  Rec.time = elapsed.count();  Rec.LogE = LogE;
+        Rec.recovered = Same_Partition(Partition, M.Parts) ? 1 : 0;
+        Rec.partition = Partition_to_String(Partition, r);
+        Records.push_back(Rec);
+        cout << "\t " << Search.first << ": \t " << Rec.time << " s, \t best MCM = " << Rec.partition << (Rec.recovered ? " (planted MCM recovered)" : "") << endl;
+      }
+      Rec.recovered = -1;
+      cout << endl;
+
+      // *** The files are updated after each dataset, so that the results are kept if the benchmark is stopped:
+      Print_Records_CSV(Records, out + ".csv");
+      Print_Records_JSON(Records, out + ".json");
+    }
+  }
+
+  remove(datafile.c_str());
+  return 0;
+}
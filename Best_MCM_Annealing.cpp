@@ -0,0 +1,274 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <map>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <cstring>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+double LogE_ICC_Sorted(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+/******************************************************************************/
+/*****************   SHARED CACHE of the LogE of the PARTS   ******************/
+/******************************************************************************/
+// Fixed-size table of (Ai, LogE(Ai)), shared by all the chains without locks:
+// the slot of Ai is given by a hash of Ai, and a new entry replaces the entry previously stored in its slot
+// (i.e. the most recently computed parts are kept).
+// Each slot is protected by a sequence number, odd while the slot is being written:
+// a reader only accepts the entry if the sequence number is even and has not changed during the read;
+// a writer gives up if another thread is already writing in the same slot.
+
+struct LogE_Slot {
+    atomic<uint32_t> seq;
+    atomic<uint32_t> Ai;      // 0 = empty slot
+    atomic<uint64_t> LogE;    // bits of the double
+};
+
+struct Shared_LogE_Cache {
+    const vector<pair<uint32_t, unsigned int>> *Kset;
+    unsigned int N;
+    uint64_t mask;            // number of slots - 1
+    vector<LogE_Slot> Slots;
+
+    atomic<uint64_t> hits;
+    atomic<uint64_t> misses;
+
+    Shared_LogE_Cache(const vector<pair<uint32_t, unsigned int>> &Kset_, unsigned int N_, unsigned int log2_size)
+      : Kset(&Kset_), N(N_), mask((1ULL << log2_size) - 1), Slots(1ULL << log2_size), hits(0), misses(0)
+    {
+      for (auto& Slot : Slots)  {  Slot.seq = 0;  Slot.Ai = 0;  Slot.LogE = 0;  }
+    }
+};
+
+uint64_t Slot_index(uint32_t Ai, uint64_t mask)
+{
+  uint64_t h = Ai * 0x9E3779B97F4A7C15ULL;
+  return (h ^ (h >> 29)) & mask;
+}
+
+bool Cache_Read(Shared_LogE_Cache &Cache, uint32_t Ai, double *LogE)
+{
+  LogE_Slot &Slot = Cache.Slots[Slot_index(Ai, Cache.mask)];
+  uint32_t seq1 = Slot.seq.load();
+  if (seq1 & 1)  {  return false;  }
+
+  uint32_t Ai_slot = Slot.Ai.load();
+  uint64_t bits = Slot.LogE.load();
+  if (Slot.seq.load() != seq1 || Ai_slot != Ai)  {  return false;  }
+
+  memcpy(LogE, &bits, sizeof(double));
+  return true;
+}
+
+void Cache_Write(Shared_LogE_Cache &Cache, uint32_t Ai, double LogE)
+{
+  LogE_Slot &Slot = Cache.Slots[Slot_index(Ai, Cache.mask)];
+  uint32_t seq = Slot.seq.load();
+  if ((seq & 1) || !Slot.seq.compare_exchange_strong(seq, seq + 1))  {  return;  }   // slot busy: don't store
+
+  uint64_t bits = 0;
+  memcpy(&bits, &LogE, sizeof(double));
+  Slot.Ai.store(Ai);
+  Slot.LogE.store(bits);
+  Slot.seq.store(seq + 2);
+}
+
+// *** LogE of the part Ai (see LogE_ICC), from the cache if possible; Kset_ICC is a buffer owned by the calling thread:
+double Shared_LogE_ICC(Shared_LogE_Cache &Cache, uint32_t Ai, vector<pair<uint32_t, unsigned int>> &Kset_ICC)
+{
+  double LogE = 0;
+  if (Cache_Read(Cache, Ai, &LogE))  {  Cache.hits++;  return LogE;  }
+
+  Cache.misses++;
+  LogE = LogE_ICC_Sorted(*(Cache.Kset), Ai, Cache.N, Kset_ICC);
+  Cache_Write(Cache, Ai, LogE);
+  return LogE;
+}
+
+/******************************************************************************/
+/*************************   ONE ANNEALING CHAIN   ****************************/
+/******************************************************************************/
+// *** Random move from the partition Parts; the parts removed are written in Old, and the parts added in New:
+// ***    - move of one operator to another part (or to a new part);
+// ***    - merge of two parts;
+// ***    - split of one part in two (random bipartition).
+void Random_Move(const vector<uint32_t> &Parts, unsigned int r, mt19937_64 &gen, vector<uint32_t> &Old, vector<uint32_t> &New)
+{
+  Old.clear();  New.clear();
+  uniform_real_distribution<double> U(0, 1);
+  unsigned int n_parts = Parts.size();
+  double move = U(gen);
+
+  if (move < 0.5)           // *** Move one operator:
+  {
+    uint32_t Op = (1UL << (gen() % r));
+    unsigned int k1 = 0;
+    while (!(Parts[k1] & Op))  {  k1++;  }
+    unsigned int k2 = gen() % (n_parts + 1);     // k2 = n_parts: new part
+    if (k2 == k1 || (k2 == n_parts && Parts[k1] == Op))  {  return;  }
+
+    Old.push_back(Parts[k1]);
+    if (Parts[k1] != Op)  {  New.push_back(Parts[k1] ^ Op);  }
+    if (k2 < n_parts)  {  Old.push_back(Parts[k2]);  New.push_back(Parts[k2] | Op);  }
+    else  {  New.push_back(Op);  }
+  }
+  else if (move < 0.75)     // *** Merge two parts:
+  {
+    if (n_parts < 2)  {  return;  }
+    unsigned int k1 = gen() % n_parts, k2 = gen() % (n_parts - 1);
+    if (k2 >= k1)  {  k2++;  }
+    Old.push_back(Parts[k1]);  Old.push_back(Parts[k2]);
+    New.push_back(Parts[k1] | Parts[k2]);
+  }
+  else                      // *** Split one part:
+  {
+    uint32_t Ai = Parts[gen() % n_parts];
+    if (bitset<32>(Ai).count() < 2)  {  return;  }
+    uint32_t A1 = 0;
+    while (A1 == 0 || A1 == Ai)  {  A1 = ((uint32_t) gen()) & Ai;  }
+    Old.push_back(Ai);
+    New.push_back(A1);  New.push_back(Ai ^ A1);
+  }
+}
+
+// *** Simulated annealing from a random partition, with a geometric cooling from T_start to T_end in n_steps steps;
+// *** Parts_best and *LogE_best are updated if a better partition is found:
+void Annealing_Chain(Shared_LogE_Cache &Cache, unsigned int r, unsigned int n_steps, double T_start, double T_end, mt19937_64 &gen, vector<uint32_t> &Parts_best, double *LogE_best)
+{
+  vector<pair<uint32_t, unsigned int>> Kset_ICC;
+  uniform_real_distribution<double> U(0, 1);
+
+  // *** Random initial partition (each operator in one of r/2 + 1 parts):
+  unsigned int n_init = r/2 + 1;
+  vector<uint32_t> Init(n_init, 0), Parts, Old, New;
+  for (unsigned int i=0; i<r; i++)  {  Init[gen() % n_init] |= (1UL << i);  }
+  for (auto const& Ai : Init)  {  if (Ai != 0)  {  Parts.push_back(Ai);  }  }
+
+  double LogE = 0;
+  for (auto const& Ai : Parts)  {  LogE += Shared_LogE_ICC(Cache, Ai, Kset_ICC);  }
+  if (LogE > (*LogE_best))  {  *LogE_best = LogE;  Parts_best = Parts;  }
+
+  double cooling = (n_steps > 1) ? pow(T_end / T_start, 1. / (n_steps - 1)) : 1;
+  double T = T_start, delta = 0;
+
+  for (unsigned int step=0; step<n_steps; step++, T *= cooling)
+  {
+    Random_Move(Parts, r, gen, Old, New);
+    if (Old.empty())  {  continue;  }
+
+    delta = 0;
+    for (auto const& Ai : New)  {  delta += Shared_LogE_ICC(Cache, Ai, Kset_ICC);  }
+    for (auto const& Ai : Old)  {  delta -= Shared_LogE_ICC(Cache, Ai, Kset_ICC);  }
+
+    if (delta >= 0 || U(gen) < exp(delta / T))
+    {
+      for (auto const& Ai : Old)
+        for (unsigned int k=0; k<Parts.size(); k++)
+          {  if (Parts[k] == Ai)  {  Parts[k] = Parts.back();  Parts.pop_back();  break;  }  }
+      Parts.insert(Parts.end(), New.begin(), New.end());
+      LogE += delta;
+
+      if (LogE > (*LogE_best) + 1e-10)  {  *LogE_best = LogE;  Parts_best = Parts;  }
+    }
+  }
+}
+
+/******************************************************************************/
+/********************   SIMULATED ANNEALING: BEST MCM   ***********************/
+/******************************************************************************/
+// *** Search for the best MCM of rank r by simulated annealing, for values of r too large for the exhaustive searches;
+// *** n_chains independent chains are run in parallel on n_threads threads (0 = number of hardware threads);
+// *** each chain is restarted n_restarts times from a random partition, and goes through n_steps random moves per restart.
+// *** The LogE of the parts is stored in a table shared by all the chains (2^log2_cache_size entries).
+// *** The result is not guaranteed to be the best MCM: the best MCM found by each chain is printed in the file
+// *** "BestMCM_Rank_r=..._Annealing.dat" (if Config.print_files).
+// *** Returns the best MCM found; *LogE_best = its LogE.
+// *** Rank r = Config.r; the messages are printed in Config.out.
+
+map<uint32_t, uint32_t> MCM_GivenRank_r_Annealing(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, const MCM_Search_Config &Config, unsigned int n_steps=100000, unsigned int n_restarts=10, unsigned int n_chains=0, unsigned int n_threads=0, unsigned int log2_cache_size=20, unsigned int seed=1)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  if (n_threads == 0)  {  n_threads = thread::hardware_concurrency();  }
+  if (n_threads == 0)  {  n_threads = 1;  }
+  if (n_chains == 0)  {  n_chains = n_threads;  }
+
+  out << "--->> Search for the best MCM of rank r=" << r << " by simulated annealing (" << n_chains << " chains, ";
+  out << n_restarts << " restarts of " << n_steps << " steps).." << endl;
+
+  Shared_LogE_Cache Cache(Kset, N, log2_cache_size);
+
+  // *** Temperature: from the typical LogE difference between two parts to a small fraction of it:
+  vector<pair<uint32_t, unsigned int>> Kset_ICC;
+  double T_start = fabs(LogE_ICC_Sorted(Kset, 1, N, Kset_ICC)) / 10. + 1, T_end = 0.01;
+
+  vector<vector<uint32_t>> Parts_chain(n_chains);
+  vector<double> LogE_chain(n_chains, -INFINITY);
+  atomic<unsigned int> next_chain(0);
+  vector<thread> Threads;
+
+  for (unsigned int t=0; t<n_threads; t++)
+  {
+    Threads.push_back(thread([&]()
+    {
+      for (unsigned int c = next_chain++; c < n_chains; c = next_chain++)
+      {
+        mt19937_64 gen(seed + c);
+        for (unsigned int k=0; k<n_restarts; k++)
+          {  Annealing_Chain(Cache, r, n_steps, T_start, T_end, gen, Parts_chain[c], &LogE_chain[c]);  }
+      }
+    }));
+  }
+  for (auto& t : Threads)  {  t.join();  }
+
+  // *** Best chain, and print in file:
+  double LogE_rank = ((double) (N * (n-r))) * log(2.);     // contribution of the non-modeled spins
+  string filename = Config.output_directory + "BestMCM_Rank_r=" + to_string(r) + "_Annealing.dat";
+  Output_File file_BestMCM;
+  if (Config.print_files)  {  file_BestMCM.open(filename);  }
+  file_BestMCM << "# 1:Partition \t 2:LogE \t 3:chain" << endl;
+
+  map<uint32_t, uint32_t> Partition_best;
+  *LogE_best = -INFINITY;
+
+  for (unsigned int c=0; c<n_chains; c++)
+  {
+    map<uint32_t, uint32_t> Partition;
+    for (unsigned int k=0; k<Parts_chain[c].size(); k++)  {  Partition[k] = Parts_chain[c][k];  }
+
+    file_BestMCM << Partition_to_String(Partition, r) << "\t " << (LogE_chain[c] - LogE_rank) << " \t " << c << endl;
+    if (LogE_chain[c] - LogE_rank > (*LogE_best))  {  *LogE_best = LogE_chain[c] - LogE_rank;  Partition_best = Partition;  }
+  }
+  file_BestMCM.close();
+
+  out << "--> Evaluations of LogE: " << Cache.misses << " (and " << Cache.hits << " found in the cache)" << endl;
+  if (Config.print_files)  {  out << "--> Best MCM of each chain printed in the file '" << filename << "'" << endl;  }
+
+  out << endl << "********** Best MCM found: **********";
+  out << endl << "\t !! The first operator of the basis provided corresponds to the bit the most on the right !!";
+  out << endl << "\t !! The last operator corresponds to the bit the most on the left !!" << endl << endl;
+  out << "\t >> Best Model = " << Partition_to_String(Partition_best, r) << "\t \t LogE = " << (*LogE_best) << endl << endl;
+
+  return Partition_best;
+}
+
+map<uint32_t, uint32_t> MCM_GivenRank_r_Annealing(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int r=n, unsigned int n_steps=100000, unsigned int n_restarts=10, unsigned int n_chains=0, unsigned int n_threads=0, unsigned int log2_cache_size=20, unsigned int seed=1)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_GivenRank_r_Annealing(Kset, N, LogE_best, Config, n_steps, n_restarts, n_chains, n_threads, log2_cache_size, seed);
+}
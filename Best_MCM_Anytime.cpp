@@ -0,0 +1,266 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+#include "data.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+double LogE_ICC_Sorted(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC);
+void Radix_Sort_States(vector<pair<uint32_t, unsigned int>> &Kset_ICC, vector<pair<uint32_t, unsigned int>> &Buffer, uint32_t Ai);
+bool SubsetDP_Fill(const vector<double> &Score_table, unsigned int r, vector<double> &Best, vector<uint32_t> &Best_Part, const chrono::steady_clock::time_point *deadline);
+map<uint32_t, uint32_t> SubsetDP_Partition(const vector<uint32_t> &Best_Part, unsigned int r);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+/******************************************************************************/
+/*************************    LogE of the PARTS   *****************************/
+/******************************************************************************/
+// LogE of the parts evaluated so far (computed at most once per part):
+struct Part_LogE_Cache {
+    const vector<pair<uint32_t, unsigned int>> *Kset;
+    unsigned int N;
+    map<uint32_t, double> LogE;
+    vector<pair<uint32_t, unsigned int>> Kset_ICC;   // buffer
+};
+
+double Cached_LogE_ICC(Part_LogE_Cache &Cache, uint32_t Ai)
+{
+  map<uint32_t, double>::iterator it = Cache.LogE.find(Ai);
+  if (it == Cache.LogE.end())  {  it = Cache.LogE.insert(make_pair(Ai, LogE_ICC_Sorted(*(Cache.Kset), Ai, Cache.N, Cache.Kset_ICC))).first;  }
+  return it->second;
+}
+
+double Cached_LogE_Parts(Part_LogE_Cache &Cache, const vector<uint32_t> &Parts)
+{
+  double LogE = 0;
+  for (auto const& Ai : Parts)  {  LogE += Cached_LogE_ICC(Cache, Ai);  }
+  return LogE;
+}
+
+/******************************************************************************/
+/****************    LOCAL IMPROVEMENT of a PARTITION   ***********************/
+/******************************************************************************/
+// *** Greedy merges: starting from Parts, merge the two parts that increase the most the LogE, as long as LogE increases,
+// *** or until the deadline:
+void Greedy_Merges(Part_LogE_Cache &Cache, vector<uint32_t> &Parts, chrono::steady_clock::time_point deadline)
+{
+  while (Parts.size() > 1)
+  {
+    double gain_best = 0;
+    unsigned int k1_best = 0, k2_best = 0;
+
+    for (unsigned int k1=0; k1<Parts.size(); k1++)
+      for (unsigned int k2=k1+1; k2<Parts.size(); k2++)
+      {
+        if (chrono::steady_clock::now() > deadline)  {  return;  }
+        double gain = Cached_LogE_ICC(Cache, Parts[k1] | Parts[k2]) - Cached_LogE_ICC(Cache, Parts[k1]) - Cached_LogE_ICC(Cache, Parts[k2]);
+        if (gain > gain_best)  {  gain_best = gain;  k1_best = k1;  k2_best = k2;  }
+      }
+
+    if (gain_best <= 0)  {  break;  }
+    Parts[k1_best] |= Parts[k2_best];
+    Parts.erase(Parts.begin() + k2_best);
+  }
+}
+
+// *** Moves of single operators: move the operator that increases the most the LogE to another part (or to a new part),
+// *** as long as LogE increases, or until the deadline:
+void Single_Operator_Moves(Part_LogE_Cache &Cache, vector<uint32_t> &Parts, unsigned int r, chrono::steady_clock::time_point deadline)
+{
+  while (chrono::steady_clock::now() < deadline)
+  {
+    double gain_best = 0;
+    uint32_t Op_best = 0;
+    unsigned int k_from = 0, k_to = 0;
+
+    for (unsigned int k1=0; k1<Parts.size(); k1++)
+      for (unsigned int i=0; i<r; i++)
+      {
+        uint32_t Op = (1UL << i);
+        if ( !(Parts[k1] & Op) )  {  continue;  }
+        if (chrono::steady_clock::now() > deadline)  {  return;  }
+
+        double LogE_from = Cached_LogE_ICC(Cache, Parts[k1]);
+        double LogE_left = (Parts[k1] == Op) ? 0 : Cached_LogE_ICC(Cache, Parts[k1] ^ Op);
+
+        for (unsigned int k2=0; k2<=Parts.size(); k2++)     // k2 = Parts.size(): new part
+        {
+          if (k2 == k1 || (k2 == Parts.size() && Parts[k1] == Op))  {  continue;  }
+          double gain = LogE_left - LogE_from;
+          if (k2 < Parts.size())  {  gain += Cached_LogE_ICC(Cache, Parts[k2] | Op) - Cached_LogE_ICC(Cache, Parts[k2]);  }
+          else  {  gain += Cached_LogE_ICC(Cache, Op);  }
+
+          if (gain > gain_best + 1e-10)  {  gain_best = gain;  Op_best = Op;  k_from = k1;  k_to = k2;  }
+        }
+      }
+
+    if (Op_best == 0)  {  break;  }
+
+    if (k_to < Parts.size())  {  Parts[k_to] |= Op_best;  }
+    else  {  Parts.push_back(Op_best);  }
+    Parts[k_from] ^= Op_best;
+    if (Parts[k_from] == 0)  {  Parts.erase(Parts.begin() + k_from);  }
+  }
+}
+
+/******************************************************************************/
+/*****************   UPPER BOUND from the COMPLETE MODEL   ********************/
+/******************************************************************************/
+// *** Max-likelihood LogL of the complete model on the r first elements (without the contribution of the non-modeled spins):
+// *** the LogE of each ICC is at most its max-likelihood LogL, and the LogL of any MCM of rank r is at most the one of the complete model,
+// *** so this is an upper bound on the LogE of all the MCMs of rank r; O(|Kset|) operations (radix sort of the projected states):
+double LogL_Complete_Model(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r)
+{
+  uint32_t R = (r < 32) ? ((1UL << r) - 1) : 0xFFFFFFFF;
+  vector<pair<uint32_t, unsigned int>> Kset_r(Kset.size()), Buffer(Kset.size());
+  for (unsigned int i=0; i<Kset.size(); i++)  {  Kset_r[i] = make_pair(Kset[i].first & R, Kset[i].second);  }
+  Radix_Sort_States(Kset_r, Buffer, R);
+
+  double LogL = 0;
+  for (unsigned int i=0; i<Kset_r.size(); )
+  {
+    unsigned int Ks = 0;
+    uint32_t s = Kset_r[i].first;
+    for ( ; i<Kset_r.size() && Kset_r[i].first == s; i++)  {  Ks += Kset_r[i].second;  }
+    LogL += Ks * log( ((double) Ks) / N );
+  }
+  return LogL;
+}
+
+/******************************************************************************/
+/*******************   Parts --> partition (map format)   *********************/
+/******************************************************************************/
+map<uint32_t, uint32_t> Parts_to_Partition(const vector<uint32_t> &Parts)
+{
+  map<uint32_t, uint32_t> Partition;
+  for (unsigned int k=0; k<Parts.size(); k++)  {  Partition[k] = Parts[k];  }
+  return Partition;
+}
+
+/******************************************************************************/
+/*******************************   ANYTIME SEARCH   ***************************/
+/******************************************************************************/
+// *** Memory of the steps 2) and 3): LogE table (double), and Best (double) and Best_Part (uint32_t) of the dynamic programming:
+const unsigned int Anytime_bytes_per_subset = 2 * sizeof(double) + sizeof(uint32_t);
+const double Anytime_max_memory = 8e9;      // bytes; above, only the step 1) is done
+// *** Search for the best MCM of rank r within a time budget (in seconds); the best MCM found is improved in the following order:
+// ***   1) promising MCMs: the independent model, the complete model, and the MCM obtained by greedy merges of the parts
+// ***      of the independent model; each of them is improved by moves of single operators between the parts;
+// ***   2) the LogE of all the 2^r possible ICCs is computed (if the budget and Anytime_max_memory allow): this tightens the upper bound
+// ***      on the LogE of the best MCM (relaxation: the LogE of each part is shared equally between its operators, and each operator
+// ***      takes its largest share over all the parts that contain it);
+// ***   3) the exact best MCM is searched by dynamic programming over the subsets (if the budget allows).
+// *** Returns the best MCM found; *LogE_best = its LogE; *LogE_bound = upper bound on the LogE of the best MCM of rank r:
+// *** always finite, it starts from the max-likelihood LogL of the complete model (see LogL_Complete_Model), is tightened by the step 2)
+// *** if the table of the 2^r ICCs is completed, and is equal to *LogE_best if the search was completed.
+// *** Rank r = Config.r; the messages are printed in Config.out (no file is printed).
+
+map<uint32_t, uint32_t> MCM_Anytime(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, double *LogE_bound, double time_budget, const MCM_Search_Config &Config)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Anytime search for the best MCM of rank r=" << r << " (time budget = " << time_budget << "s).." << endl;
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  chrono::steady_clock::time_point deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(time_budget));
+
+  double LogE_rank = ((double) (N * (n-r))) * log(2.);     // contribution of the non-modeled spins
+  Part_LogE_Cache Cache;
+  Cache.Kset = &Kset;  Cache.N = N;
+
+  // *** 1) Promising MCMs:
+  vector<uint32_t> Parts_Indep, Parts_Complete(1, (uint32_t) ((1UL << r) - 1));
+  for (unsigned int i=0; i<r; i++)  {  Parts_Indep.push_back(1UL << i);  }
+
+  vector<vector<uint32_t>> Seeds;
+  Seeds.push_back(Parts_Indep);
+  Seeds.push_back(Parts_Complete);
+  Seeds.push_back(Parts_Indep);   Greedy_Merges(Cache, Seeds.back(), deadline);
+
+  vector<uint32_t> Parts_best = Parts_Indep;
+  double LogE = 0;
+  *LogE_best = Cached_LogE_Parts(Cache, Parts_best);
+
+  for (auto& Parts : Seeds)
+  {
+    Single_Operator_Moves(Cache, Parts, r, deadline);
+    LogE = Cached_LogE_Parts(Cache, Parts);
+    if (LogE > (*LogE_best))  {  *LogE_best = LogE;  Parts_best = Parts;  }
+  }
+  out << "--> Best LogE after the greedy steps: " << (*LogE_best) - LogE_rank << endl;
+
+  // *** 2) LogE of all the ICCs and upper bound (only if the table and the dynamic programming fit in Anytime_max_memory):
+  *LogE_bound = LogL_Complete_Model(Kset, N, r);
+  bool exact = false;
+  bool table_complete = (r < 32) && ( (double) Anytime_bytes_per_subset * pow(2., r) <= Anytime_max_memory );
+  if (!table_complete)  {  out << "--> Rank too large for the table of the 2^r ICCs: upper bound from the complete model, no exact search" << endl;  }
+
+  size_t Nsub = (table_complete) ? ((size_t) 1 << r) : 0;
+  vector<double> LogE_table(Nsub, 0);
+
+  for (size_t Ai = 1; Ai < Nsub; Ai++)      // the parts of the promising MCMs are read in the cache, the others are not stored in it
+  {
+    if (chrono::steady_clock::now() > deadline)  {  table_complete = false;  break;  }
+    map<uint32_t, double>::const_iterator it = Cache.LogE.find(Ai);
+    LogE_table[Ai] = (it != Cache.LogE.end()) ? it->second : LogE_ICC_Sorted(Kset, Ai, N, Cache.Kset_ICC);
+  }
+  Cache.LogE.clear();
+
+  if (table_complete)
+  {
+    vector<double> Share(r, -INFINITY);     // Share[i] = max over the parts Ai containing i of LogE(Ai)/|Ai|
+    for (size_t Ai = 1; Ai < Nsub; Ai++)
+    {
+      double share = LogE_table[Ai] / bitset<n>(Ai).count();
+      for (unsigned int i=0; i<r; i++)  {  if ( ((Ai >> i) & 1) && share > Share[i] )  {  Share[i] = share;  }  }
+    }
+    double LogE_shares = 0;
+    for (unsigned int i=0; i<r; i++)  {  LogE_shares += Share[i];  }
+    *LogE_bound = min(*LogE_bound, LogE_shares);
+
+    // *** 3) Exact search, until the deadline:
+    vector<double> Best;
+    vector<uint32_t> Best_Part;
+
+    if (SubsetDP_Fill(LogE_table, r, Best, Best_Part, &deadline))
+    {
+      exact = true;
+      *LogE_bound = Best[Nsub-1];
+      if (Best[Nsub-1] > (*LogE_best))
+      {
+        *LogE_best = Best[Nsub-1];
+        Parts_best.clear();
+        for (auto const& Part : SubsetDP_Partition(Best_Part, r))  {  Parts_best.push_back(Part.second);  }
+      }
+    }
+  }
+
+  *LogE_best -= LogE_rank;
+  *LogE_bound -= LogE_rank;
+
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  map<uint32_t, uint32_t> Partition = Parts_to_Partition(Parts_best);
+
+  out << "--> Elapsed time: " << elapsed.count() << "s;  search " << (exact ? "completed (exact best MCM)" : "stopped before the end") << endl << endl;
+  out << "\t >> Best Model = " << Partition_to_String(Partition, r) << "\t \t LogE = " << (*LogE_best) << endl;
+  out << "\t >> Upper bound on the LogE of the best MCM = " << (*LogE_bound) << "  (gap = " << (*LogE_bound) - (*LogE_best) << ")" << endl << endl;
+
+  return Partition;
+}
+
+map<uint32_t, uint32_t> MCM_Anytime(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, double *LogE_bound, double time_budget, unsigned int r=n)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_Anytime(Kset, N, LogE_best, LogE_bound, time_budget, Config);
+}
@@ -0,0 +1,241 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <map>
+#include <vector>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+map<uint32_t, uint32_t> Convert_Partition_forMCM(uint32_t *a, unsigned int r);
+
+double LogE_ICC_Sorted(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC);
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best);
+
+/******************************************************************************/
+/**************************   CONSTRAINTS on the PARTS   **********************/
+/******************************************************************************/
+// The constraints are given with the positions of the operators in the basis (from 0 to r-1; 0 = first operator = bit the most on the right):
+// ***   - max_size: maximum number of operators in a part;
+// ***   - Together: pairs of operators that must be in the same part;
+// ***   - Apart: pairs of operators that must be in different parts.
+// Together_mask[i] = operators that must be in the same part as i (transitive closure of the pairs in Together);
+// Apart_mask[i] = operators that must not be in the same part as i.
+
+void Constraint_Masks(const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, unsigned int r, vector<uint32_t> &Together_mask, vector<uint32_t> &Apart_mask)
+{
+  Together_mask.assign(r, 0);
+  Apart_mask.assign(r, 0);
+  for (unsigned int i=0; i<r; i++)  {  Together_mask[i] = (1UL << i);  }
+
+  for (auto const& pair_ij : Together)
+    {  if (pair_ij.first < r && pair_ij.second < r)  {  Together_mask[pair_ij.first] |= (1UL << pair_ij.second);  Together_mask[pair_ij.second] |= (1UL << pair_ij.first);  }  }
+  for (auto const& pair_ij : Apart)
+    {  if (pair_ij.first < r && pair_ij.second < r)  {  Apart_mask[pair_ij.first] |= (1UL << pair_ij.second);  Apart_mask[pair_ij.second] |= (1UL << pair_ij.first);  }  }
+
+  // *** Transitive closure of Together:
+  bool changed = true;
+  while (changed)
+  {
+    changed = false;
+    for (unsigned int i=0; i<r; i++)
+      for (unsigned int j=0; j<r; j++)
+        if ( ((Together_mask[i] >> j) & 1) && (Together_mask[j] | Together_mask[i]) != Together_mask[i] )
+          {  Together_mask[i] |= Together_mask[j];  changed = true;  }
+  }
+}
+
+// *** Check if the part Ai satisfies all the constraints:
+bool Part_Allowed(uint32_t Ai, unsigned int max_size, const vector<uint32_t> &Together_mask, const vector<uint32_t> &Apart_mask)
+{
+  if (bitset<32>(Ai).count() > max_size)  {  return false;  }
+  for (unsigned int i=0; i<Together_mask.size(); i++)
+  {
+    if ( !((Ai >> i) & 1) )  {  continue;  }
+    if ( (Together_mask[i] & ~Ai) != 0 || (Apart_mask[i] & Ai) != 0 )  {  return false;  }
+  }
+  return true;
+}
+
+/******************************************************************************/
+/**********   ENUMERATION of the ALLOWED PARTITIONS only (Version 1)   ********/
+/******************************************************************************/
+// The partitions are generated as restricted growth strings a[0..r-1] (same format as Algorithm H, a[i] <-> operator r-1-i),
+// by assigning the operators one by one to an existing part or to a new part;
+// an operator is only assigned to a part if the constraints can still be satisfied, so that disallowed partitions are never visited.
+
+struct Constrained_Enumeration {
+    unsigned int r;
+    unsigned int max_size;
+    vector<uint32_t> Together_mask, Apart_mask;
+
+    const vector<pair<uint32_t, unsigned int>> *Kset;
+    unsigned int N;
+    map<uint32_t, double> LogE_Parts;                 // LogE of the parts evaluated so far
+    vector<pair<uint32_t, unsigned int>> Kset_ICC;    // buffer
+
+    vector<uint32_t> a, aBest;
+    vector<uint32_t> Parts;                           // parts of the current (incomplete) partition
+    double LogE_best;
+    unsigned long long counter;
+    Output_File *file_BestMCM;
+    string xx_st;
+    double LogE_rank;                                 // contribution of the non-modeled spins
+};
+
+void Visit_Constrained(Constrained_Enumeration &E, unsigned int i, uint32_t placed)
+{
+  if (i == E.r)     // *** Complete partition:
+  {
+    E.counter++;
+    double LogE = 0;
+    for (auto const& Ai : E.Parts)
+    {
+      map<uint32_t, double>::iterator it = E.LogE_Parts.find(Ai);
+      if (it == E.LogE_Parts.end())  {  it = E.LogE_Parts.insert(make_pair(Ai, LogE_ICC_Sorted(*(E.Kset), Ai, E.N, E.Kset_ICC))).first;  }
+      LogE += it->second;
+    }
+    if (LogE > E.LogE_best)
+    {
+      E.LogE_best = LogE;  E.aBest = E.a;
+      (*E.file_BestMCM) << E.xx_st;
+      for (auto const& digit : E.a)  {  (*E.file_BestMCM) << digit;  }
+      (*E.file_BestMCM) << "\t " << (LogE - E.LogE_rank) << " \t New \t " << E.counter << endl;
+    }
+    return;
+  }
+
+  unsigned int op = E.r - 1 - i;
+  uint32_t Op = (1UL << op);
+  uint32_t partners = E.Together_mask[op] & placed & ~Op;   // operators already placed that must be with op
+
+  for (unsigned int k=0; k<=E.Parts.size(); k++)            // k = Parts.size(): new part
+  {
+    if (k < E.Parts.size())
+    {
+      uint32_t Ai = E.Parts[k];
+      if ( (Ai & E.Apart_mask[op]) || (partners & ~Ai) || bitset<32>(Ai).count() >= E.max_size )  {  continue;  }
+      // *** the part Ai must still be able to receive all the operators that must be with its elements (and with op):
+      uint32_t required = Op;
+      for (unsigned int j=0; j<E.r; j++)  {  if ((Ai >> j) & 1)  {  required |= E.Together_mask[j];  }  }
+      required |= E.Together_mask[op];
+      if (bitset<32>(required | Ai).count() > E.max_size)  {  continue;  }
+
+      E.Parts[k] |= Op;  E.a[i] = k;
+      Visit_Constrained(E, i+1, placed | Op);
+      E.Parts[k] ^= Op;
+    }
+    else
+    {
+      if (partners != 0 || bitset<32>(E.Together_mask[op]).count() > E.max_size)  {  continue;  }
+      E.Parts.push_back(Op);  E.a[i] = k;
+      Visit_Constrained(E, i+1, placed | Op);
+      E.Parts.pop_back();
+    }
+  }
+}
+
+/******************************************************************************/
+// *** Version 1 with constraints:
+// ***            Compare all the MCM of rank r = Config.r that satisfy the constraints (see above),
+// ***            based on the r first elements of the basis used to build Kset;
+// ***            the successive best MCMs are printed in the file "BestMCM_Rank_r=..._Constrained.dat" (if Config.print_files).
+// ***            Returns an empty partition if no partition satisfies the constraints.
+/******************************************************************************/
+map<uint32_t, uint32_t> MCM_GivenRank_r_Constrained(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int max_size, const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, const MCM_Search_Config &Config)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Search for the best MCM with constraints (maximum size of a part = " << max_size << ", ";
+  out << Together.size() << " pairs together, " << Apart.size() << " pairs apart).." << endl << endl;
+
+  string xx_st = "";
+  for(unsigned int i=0; i<n-r; i++)
+    {  xx_st += "_";  }
+
+  Output_File file_BestMCM;
+  if (Config.print_files)  {  file_BestMCM.open(Config.output_directory + "BestMCM_Rank_r=" + to_string(r) + "_Constrained.dat");  }
+  file_BestMCM << "# 1:Partition \t 2:LogE " << endl;
+
+  Constrained_Enumeration E;
+  E.r = r;  E.max_size = max_size;
+  Constraint_Masks(Together, Apart, r, E.Together_mask, E.Apart_mask);
+  E.Kset = &Kset;  E.N = N;
+  E.a.assign(r, 0);
+  E.LogE_best = -INFINITY;
+  E.counter = 0;
+  E.file_BestMCM = &file_BestMCM;
+  E.xx_st = xx_st;
+  E.LogE_rank = ((double) (N * (n-r))) * log(2.);
+
+  Visit_Constrained(E, 0, 0);
+  file_BestMCM.close();
+
+  out << "--> Number of MCModels (of rank r=" << r << ") that satisfy the constraints and were compared: " << E.counter << endl;
+
+  map<uint32_t, uint32_t> Partition;
+  *LogE_best = -INFINITY;
+  if (E.counter == 0)  {  out << "--> No partition satisfies the constraints" << endl << endl;  return Partition;  }
+
+  *LogE_best = E.LogE_best - E.LogE_rank;
+
+  out << endl << "********** Best MCM: **********";
+  out << endl << "\t !! The first operator of the basis provided corresponds to the bit the most on the right !!";
+  out << endl << "\t !! The last operator corresponds to the bit the most on the left !!" << endl << endl;;
+
+  out << "\t >> Best Model = " << xx_st;
+  for(unsigned int i=0; i<r; i++) {  out << E.aBest[i];  }
+  out << "\t \t LogE = " << (*LogE_best) << endl << endl;
+
+  Partition = Convert_Partition_forMCM(E.aBest.data(), r);
+  return Partition;
+}
+
+map<uint32_t, uint32_t> MCM_GivenRank_r_Constrained(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int max_size, const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, unsigned int r=n)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_GivenRank_r_Constrained(Kset, N, LogE_best, max_size, Together, Apart, Config);
+}
+
+/******************************************************************************/
+/*************   DYNAMIC PROGRAMMING over SUBSETS with CONSTRAINTS   **********/
+/******************************************************************************/
+// *** LogE_table[Ai] = LogE_ICC(Kset, Ai, N) for the allowed parts, and -INFINITY for the others (which are not computed),
+// *** to be used with MCM_SubsetDP():
+vector<double> LogE_AllSubsets_Constrained(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int max_size, const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, unsigned int r=n)
+{
+  vector<uint32_t> Together_mask, Apart_mask;
+  Constraint_Masks(Together, Apart, r, Together_mask, Apart_mask);
+
+  uint32_t Nsub = (1UL << r);
+  vector<double> LogE_table(Nsub, -INFINITY);
+  vector<pair<uint32_t, unsigned int>> Kset_ICC;
+  LogE_table[0] = 0;
+
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+    {  if (Part_Allowed(Ai, max_size, Together_mask, Apart_mask))  {  LogE_table[Ai] = LogE_ICC_Sorted(Kset, Ai, N, Kset_ICC);  }  }
+
+  return LogE_table;
+}
+
+// *** Same result as MCM_GivenRank_r_Constrained, nothing is printed;
+// *** returns an empty partition (and *LogE_best = -INFINITY) if no partition satisfies the constraints:
+map<uint32_t, uint32_t> MCM_GivenRank_r_SubsetDP_Constrained(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int max_size, const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, unsigned int r=n)
+{
+  vector<double> LogE_table = LogE_AllSubsets_Constrained(Kset, N, max_size, Together, Apart, r);
+
+  map<uint32_t, uint32_t> Partition = MCM_SubsetDP(LogE_table, r, LogE_best);
+  if ((*LogE_best) == -INFINITY)  {  Partition.clear();  return Partition;  }
+
+  (*LogE_best) -= ((double) (N * (n-r))) * log(2.);     // contribution of the non-modeled spins
+  return Partition;
+}
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "partition.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+double GeomComplexity_ICC(unsigned int m);
+double ParamComplexity_ICC(unsigned int m, unsigned int N);
+
+map<uint32_t, uint32_t> Convert_Partition_forMCM(uint32_t *a, unsigned int r);
+unsigned long long For_Each_Partition(unsigned int r, const function<void(const uint32_t *a, const Partition_t &Partition)> &Visit);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+/******************************************************************************/
+/*******************   CRITERIA for ALL the possible ICCs   *******************/
+/******************************************************************************/
+// Criteria used to select the best MCM (all to be maximized, all additive over the parts of an MCM):
+// ***   0: LogE       = log-evidence (see LogE_MCM);
+// ***   1: MDL        = LogL - C_param - C_geom (see PrintTerminal_MCM_Info);
+// ***   2: BIC        = LogL - (number of parameters / 2) * log(N)   (i.e. -BIC/2, with BIC = -2 LogL + K log N);
+// ***   3: LogL_test  = held-out log-likelihood of a test set (see LogL_MCM_HeldOut), only if a test set is given.
+
+const vector<string> Criteria_names = {"LogE", "MDL", "BIC", "LogL_test"};
+
+// *** Table[c][Ai] = value of the criterion c for the part Ai (without the contribution of the non-modeled spins);
+// *** the histograms of the ICC in the training and test sets are obtained by sorting, once per part:
+vector<vector<double>> Criteria_AllSubsets(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const vector<pair<uint32_t, unsigned int>> &Kset_test, unsigned int r)
+{
+  uint32_t Nsub = (1UL << r);
+  unsigned int n_criteria = Kset_test.empty() ? 3 : 4;
+  vector<vector<double>> Table(n_criteria, vector<double>(Nsub, 0));
+
+  vector<pair<uint32_t, unsigned int>> Kset_ICC(Kset.size()), Kset_ICC_test(Kset_test.size());
+  double Nd = N, logN = log(Nd);
+
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+  {
+    uint32_t m = bitset<n>(Ai).count();
+    double Z = Nd + (double) ( 1UL << (m-1) );
+
+    for (unsigned int i=0; i<Kset.size(); i++)  {  Kset_ICC[i] = make_pair(Kset[i].first & Ai, Kset[i].second);  }
+    sort(Kset_ICC.begin(), Kset_ICC.end());
+    for (unsigned int i=0; i<Kset_test.size(); i++)  {  Kset_ICC_test[i] = make_pair(Kset_test[i].first & Ai, Kset_test[i].second);  }
+    sort(Kset_ICC_test.begin(), Kset_ICC_test.end());
+
+    double LogE = 0, LogL = 0, LogL_test = 0;
+    unsigned int Ks = 0, K_ICC = 0, j = 0;
+
+    for (unsigned int i=0; i<Kset_ICC.size(); )
+    {
+      uint32_t s = Kset_ICC[i].first;
+      for (Ks = 0; i<Kset_ICC.size() && Kset_ICC[i].first == s; i++)  {  Ks += Kset_ICC[i].second;  }
+      LogE += lgamma(Ks + 0.5);
+      LogL += Ks * log((double) Ks / Nd);
+      K_ICC++;
+
+      // *** Test states that precede s are not observed in the training set:
+      for ( ; j<Kset_ICC_test.size() && Kset_ICC_test[j].first < s; j++)  {  LogL_test += Kset_ICC_test[j].second * log(0.5 / Z);  }
+      for ( ; j<Kset_ICC_test.size() && Kset_ICC_test[j].first == s; j++)  {  LogL_test += Kset_ICC_test[j].second * log((Ks + 0.5) / Z);  }
+    }
+    for ( ; j<Kset_ICC_test.size(); j++)  {  LogL_test += Kset_ICC_test[j].second * log(0.5 / Z);  }
+
+    LogE += lgamma((double)( 1UL << (m-1) )) - (K_ICC/2.) * log(M_PI) - lgamma( (double)( N + (1UL << (m-1)) ) );
+
+    Table[0][Ai] = LogE;
+    Table[1][Ai] = LogL - ParamComplexity_ICC(m, N) - GeomComplexity_ICC(m);
+    Table[2][Ai] = LogL - ((double) ((1UL << m) - 1)) / 2. * logN;
+    if (n_criteria == 4)  {  Table[3][Ai] = LogL_test;  }
+  }
+
+  return Table;
+}
+
+/******************************************************************************/
+/******************   BEST MCM for SEVERAL CRITERIA at ONCE   *****************/
+/******************************************************************************/
+// *** Compare all the MCM of rank r = Config.r (Algorithm H, as in Version 1), and keep the best MCM for each criterion (see above)
+// *** in the same pass; the value of each criterion is a sum over the parts, read in the tables computed beforehand.
+// *** The held-out LogL is only computed if a test set (Kset_test, N_test) is given, written in the same basis as Kset.
+// *** The best MCM for each criterion is printed in the file "BestMCM_Rank_r=..._MultiCriteria.dat" (if Config.print_files).
+// *** Returns, for each criterion name: (value of the criterion for the best MCM, best MCM).
+
+map<string, pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_MultiCriteria(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const MCM_Search_Config &Config, const vector<pair<uint32_t, unsigned int>> &Kset_test = vector<pair<uint32_t, unsigned int>>(), unsigned int N_test=0)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Search for the best MCM of rank r=" << r << " for several criteria.." << endl << endl;
+
+  vector<vector<double>> Table = Criteria_AllSubsets(Kset, N, Kset_test, r);
+  unsigned int n_criteria = Table.size();
+
+  // *** Contribution of the non-modeled spins:
+  vector<double> Value_rank(n_criteria, ((double) (N * (n-r))) * log(2.));
+  if (n_criteria == 4)  {  Value_rank[3] = ((double) (N_test * (n-r))) * log(2.);  }
+
+  // *** Algorithm H (see For_Each_Partition):
+  vector<vector<uint32_t>> aBest(n_criteria, vector<uint32_t>(r, 0));
+  vector<double> Value(n_criteria, 0), Value_best(n_criteria, -INFINITY);
+  unsigned int c = 0;
+
+  unsigned long long counter = For_Each_Partition(r, [&](const uint32_t *a, const Partition_t &Partition)
+  {
+    for (c=0; c<n_criteria; c++)
+    {
+      Value[c] = 0;
+      for (unsigned int i=0; i<Partition.size; i++)  {  Value[c] += Table[c][Partition.Part[i]];  }
+      if (Value[c] > Value_best[c])  {  Value_best[c] = Value[c];  aBest[c].assign(a, a+r);  }
+    }
+  });
+
+  // *** Results:
+  map<string, pair<double, map<uint32_t, uint32_t>>> Results;
+
+  string filename = Config.output_directory + "BestMCM_Rank_r=" + to_string(r) + "_MultiCriteria.dat";
+  Output_File file_Best;
+  if (Config.print_files)  {  file_Best.open(filename);  }
+  file_Best << "# 1:Criterion \t 2:Best MCM \t 3:Value of the criterion \t 4:LogE of this MCM" << endl;
+
+  out << "--> Number of MCModels (of rank r=" << r << ") that were compared: " << counter << endl << endl;
+
+  for (c=0; c<n_criteria; c++)
+  {
+    map<uint32_t, uint32_t> Partition = Convert_Partition_forMCM(aBest[c].data(), r);
+    double value = Value_best[c] - Value_rank[c];
+
+    double LogE = -Value_rank[0];
+    for (auto const& Part : Partition)  {  LogE += Table[0][Part.second];  }
+
+    Results[Criteria_names[c]] = make_pair(value, Partition);
+    file_Best << Criteria_names[c] << " \t" << Partition_to_String(Partition, r) << " \t" << value << " \t" << LogE << endl;
+    out << "\t >> Best Model for " << Criteria_names[c] << " = " << Partition_to_String(Partition, r) << "\t \t " << Criteria_names[c] << " = " << value << endl;
+  }
+  file_Best.close();
+
+  if (Config.print_files)  {  out << endl << "--> Best MCMs printed in the file '" << filename << "'" << endl << endl;  }
+
+  return Results;
+}
+
+map<string, pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_MultiCriteria(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n, const vector<pair<uint32_t, unsigned int>> &Kset_test = vector<pair<uint32_t, unsigned int>>(), unsigned int N_test=0)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_GivenRank_r_MultiCriteria(Kset, N, Config, Kset_test, N_test);
+}
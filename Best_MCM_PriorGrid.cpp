@@ -0,0 +1,130 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "partition.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+map<uint32_t, uint32_t> Convert_Partition_forMCM(uint32_t *a, unsigned int r);
+unsigned long long For_Each_Partition(unsigned int r, const function<void(const uint32_t *a, const Partition_t &Partition)> &Visit);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+/******************************************************************************/
+/*************   LogE of ALL the possible ICCs for a GRID of ALPHA   **********/
+/******************************************************************************/
+// LogE_table[Ai * n_alpha + k] = LogE_ICC_alpha(Kset, Ai, N, Alpha[k]), for all the parts Ai of the r first basis elements;
+// the histogram of each ICC is built once (by sorting), and then used for all the values of alpha;
+// the values for the different alpha are contiguous, so that the loops over alpha can be vectorized by the compiler.
+
+vector<double> LogE_AllSubsets_alpha(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const vector<double> &Alpha, unsigned int r=n)
+{
+  unsigned int n_alpha = Alpha.size();
+  uint32_t Nsub = (1UL << r);
+  vector<double> LogE_table(((size_t) Nsub) * n_alpha, 0);
+
+  vector<double> lgamma_alpha(n_alpha);
+  for (unsigned int k=0; k<n_alpha; k++)  {  lgamma_alpha[k] = lgamma(Alpha[k]);  }
+
+  vector<pair<uint32_t, unsigned int>> Kset_ICC(Kset.size());
+  vector<double> LogE(n_alpha);
+
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+  {
+    for (unsigned int i=0; i<Kset.size(); i++)  {  Kset_ICC[i] = make_pair(Kset[i].first & Ai, Kset[i].second);  }
+    sort(Kset_ICC.begin(), Kset_ICC.end());
+
+    uint32_t m = bitset<n>(Ai).count();
+    double n_states = (double) (1UL << m);
+    for (unsigned int k=0; k<n_alpha; k++)  {  LogE[k] = lgamma(n_states * Alpha[k]) - lgamma(N + n_states * Alpha[k]);  }
+
+    for (unsigned int i=0; i<Kset_ICC.size(); )
+    {
+      unsigned int Ks = 0;
+      uint32_t s = Kset_ICC[i].first;
+      for ( ; i<Kset_ICC.size() && Kset_ICC[i].first == s; i++)  {  Ks += Kset_ICC[i].second;  }
+      for (unsigned int k=0; k<n_alpha; k++)  {  LogE[k] += lgamma(Ks + Alpha[k]) - lgamma_alpha[k];  }
+    }
+
+    for (unsigned int k=0; k<n_alpha; k++)  {  LogE_table[((size_t) Ai) * n_alpha + k] = LogE[k];  }
+  }
+
+  return LogE_table;
+}
+
+/******************************************************************************/
+/*****************   BEST MCM for a GRID of DIRICHLET PRIORS   ****************/
+/******************************************************************************/
+// *** Compare all the MCM of rank r = Config.r (Algorithm H, as in Version 1), with the LogE computed for all the values
+// *** of the parameter alpha of the Dirichlet prior in Alpha (see LogE_ICC_alpha) in the same pass;
+// *** The best MCM for each alpha is printed in the file "BestMCM_Rank_r=..._PriorGrid.dat" (if Config.print_files).
+// *** Returns, for each alpha (in the same order as Alpha): (LogE of the best MCM, best MCM).
+
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_PriorGrid(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const vector<double> &Alpha, const MCM_Search_Config &Config)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Search for the best MCM of rank r=" << r << " for " << Alpha.size() << " values of the Dirichlet prior parameter.." << endl << endl;
+
+  unsigned int n_alpha = Alpha.size();
+  vector<double> LogE_table = LogE_AllSubsets_alpha(Kset, N, Alpha, r);
+
+  // *** Algorithm H (see For_Each_Partition):
+  vector<vector<uint32_t>> aBest(n_alpha, vector<uint32_t>(r, 0));
+  vector<double> LogE(n_alpha, 0), LogE_best(n_alpha, -INFINITY);
+  unsigned int k = 0;
+
+  unsigned long long counter = For_Each_Partition(r, [&](const uint32_t *a, const Partition_t &Partition)
+  {
+    for (k=0; k<n_alpha; k++)  {  LogE[k] = 0;  }
+    for (unsigned int i=0; i<Partition.size; i++)
+    {
+      const double *LogE_Part = &LogE_table[((size_t) Partition.Part[i]) * n_alpha];
+      for (k=0; k<n_alpha; k++)  {  LogE[k] += LogE_Part[k];  }
+    }
+    for (k=0; k<n_alpha; k++)
+      {  if (LogE[k] > LogE_best[k])  {  LogE_best[k] = LogE[k];  aBest[k].assign(a, a+r);  }  }
+  });
+
+  // *** Results:
+  double LogE_rank = ((double) (N * (n-r))) * log(2.);     // contribution of the non-modeled spins
+  vector<pair<double, map<uint32_t, uint32_t>>> Results(n_alpha);
+
+  string filename = Config.output_directory + "BestMCM_Rank_r=" + to_string(r) + "_PriorGrid.dat";
+  Output_File file_Best;
+  if (Config.print_files)  {  file_Best.open(filename);  }
+  file_Best << "# 1:alpha \t 2:Best MCM \t 3:LogE" << endl;
+
+  out << "--> Number of MCModels (of rank r=" << r << ") that were compared: " << counter << endl << endl;
+
+  for (k=0; k<n_alpha; k++)
+  {
+    Results[k] = make_pair(LogE_best[k] - LogE_rank, Convert_Partition_forMCM(aBest[k].data(), r));
+    file_Best << Alpha[k] << " \t" << Partition_to_String(Results[k].second, r) << " \t" << Results[k].first << endl;
+    out << "\t alpha = " << Alpha[k] << ": \t Best Model = " << Partition_to_String(Results[k].second, r) << "\t \t LogE = " << Results[k].first << endl;
+  }
+  file_Best.close();
+
+  if (Config.print_files)  {  out << endl << "--> Best MCMs printed in the file '" << filename << "'" << endl << endl;  }
+
+  return Results;
+}
+
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_PriorGrid(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const vector<double> &Alpha, unsigned int r=n)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_GivenRank_r_PriorGrid(Kset, N, Alpha, Config);
+}
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <map>
+#include <vector>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "progress.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+vector<double> LogE_AllSubsets_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r);
+
+double GeomComplexity_ICC(unsigned int m);
+double ParamComplexity_ICC(unsigned int m, unsigned int N);
+
+map<uint32_t, uint32_t> Convert_Partition_forMCM(uint32_t *a, unsigned int r);
+
+Search_Progress Progress_Start(string name, double total, double interval, string filename);
+void Progress_Update(Search_Progress &P, unsigned long long counter, double LogE_best);
+void Progress_End(Search_Progress &P, unsigned long long counter, double LogE_best);
+
+/******************************************************************************/
+/***************************   CONSTANT TABLES   ******************************/
+/******************************************************************************/
+// *** Bell numbers: Bell_numbers[r] = number of partitions of a set of r elements = number of MCMs of rank r:
+constexpr unsigned long long Bell_numbers[21] = {1ULL, 1ULL, 2ULL, 5ULL, 15ULL, 52ULL, 203ULL, 877ULL, 4140ULL, 21147ULL, 115975ULL,
+                                                 678570ULL, 4213597ULL, 27644437ULL, 190899322ULL, 1382958545ULL, 10480142147ULL,
+                                                 82864869804ULL, 682076806159ULL, 5832742205057ULL, 51724158235372ULL};
+
+const unsigned int r_min_Specialized = 2;
+const unsigned int r_max_Specialized = 20;
+
+/******************************************************************************/
+/**************   KERNEL of VERSION 1 for a FIXED RANK R   ********************/
+/******************************************************************************/
+// Same algorithm as MCM_GivenRank_r (Algorithm H), with the rank R known at compile time:
+// ***   - a[] and b[] are fixed-size arrays, so that the loops over a[0..R-1] can be unrolled by the compiler;
+// ***   - the LogE of all the 2^R parts are computed at once before the search (see LogE_AllSubsets_Projected), and then read in a table;
+// ***   - the complexities of the parts (printed if print_bool = true) are read in tables indexed by the size m of the part.
+// The files printed and the LogE-values are the same as for MCM_GivenRank_r; returns the number of MCMs compared.
+
+template <unsigned int R>
+unsigned long long MCM_GivenRank_R_Kernel(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, uint32_t *aBest, const MCM_Search_Config &Config, const string &xx_st, Output_File &file_BestMCM, Output_File &file_MCM_Rank_r)
+{
+  // *** Tables:
+  vector<double> LogE_Part = LogE_AllSubsets_Projected(Kset, N, R);
+  double C_param_m[R+1], C_geom_m[R+1];
+  for (unsigned int m=1; m<=R; m++)  {  C_param_m[m] = ParamComplexity_ICC(m, N);  C_geom_m[m] = GeomComplexity_ICC(m);  }
+
+  double LogE_rank = ((double) (N * (n-R))) * log(2.);     // contribution of the non-modeled spins
+
+  // *** H1: Initialisation:
+  uint32_t a[R], b[R], Parts[R];
+  for (unsigned int i=0; i<R; i++)  {  a[i] = 0;  b[i] = 1;  aBest[i] = 0;  }
+  unsigned long long counter = 0;
+  unsigned int n_parts = 0, i = 0;
+  int j = R-1;
+  double LogE = 0, C_param = 0, C_geom = 0;
+
+  *LogE_best = LogE_Part[(1UL << R) - 1] - LogE_rank;     // initial partition: a single part
+
+  const bool print_bool = Config.print_bool;
+  Search_Progress Progress = Progress_Start("MCM_GivenRank_r_Specialized", (double) Bell_numbers[R], Config.progress_interval, Config.progress_filename);
+
+  // *** ALGO H:
+  while (true)
+  {
+    // *** H2: Visit:
+    counter++;
+    if ((counter & Progress_check_mask) == 0)  {  Progress_Update(Progress, counter, *LogE_best);  }
+    for (i=0; i<R; i++)  {  Parts[i] = 0;  }
+    n_parts = 0;
+    for (i=0; i<R; i++)  {  Parts[a[i]] |= (1UL << (R-1-i));  if (a[i] + 1 > n_parts)  {  n_parts = a[i] + 1;  }  }
+
+    LogE = 0;
+    for (i=0; i<n_parts; i++)  {  LogE += LogE_Part[Parts[i]];  }
+    LogE -= LogE_rank;
+
+    // *** Print in file:
+    if (print_bool)
+    {
+      C_param = 0;  C_geom = 0;
+      for (i=0; i<n_parts; i++)
+      {
+        unsigned int m = bitset<R>(Parts[i]).count();
+        C_param += C_param_m[m];  C_geom += C_geom_m[m];
+      }
+      file_MCM_Rank_r << xx_st;
+      for (i=0; i<R; i++)   {    file_MCM_Rank_r << a[i];  }
+      file_MCM_Rank_r << " \t" << LogE << " \t" << C_param << " \t" << C_geom << " \t" << (C_param + C_geom) << " \t" << counter << endl;
+    }
+
+    // *** Best MCM LogE:
+    if (LogE >= (*LogE_best))
+    {
+      file_BestMCM << xx_st;
+      for (i=0; i<R; i++)   {    file_BestMCM << a[i];  aBest[i] = a[i];  }
+      file_BestMCM << "\t " << LogE << ((LogE > (*LogE_best)) ? " \t New \t " : " \t Idem \t ") << counter << endl;
+      *LogE_best = LogE;
+    }
+
+    if (a[R-1] != b[R-1])  {  a[R-1] += 1;  }   // H3: increase a[R-1] up to reaching b[R-1]
+    else
+    {
+      j = R-2;                                    // H4: find first index j (from the right) such that a[j] != b[j]
+      while (a[j] == b[j])  {  j--;  }
+      if (j==0) { break;  }                       // H5: Increase a[j] unless j=0 [Terminate]
+      a[j] += 1;
+      b[R-1] = b[j] + ((a[j]==b[j])?1:0);
+      for (j++; j < (int) (R-1); j++)  {  a[j] = 0;  b[j] = b[R-1];  }   // H6: zero out a[j+1], ..., a[R-1]
+      a[R-1] = 0;
+    }
+  }
+
+  Progress_End(Progress, counter, *LogE_best);
+  return counter;
+}
+
+/******************************************************************************/
+/*******************   DISPATCH on the RANK r at RUNTIME   ********************/
+/******************************************************************************/
+// *** Instantiations of the kernel for r_min_Specialized <= R <= r_max_Specialized, indexed by R:
+typedef unsigned long long (*MCM_Kernel_t)(const vector<pair<uint32_t, unsigned int>> &, unsigned int, double *, uint32_t *, const MCM_Search_Config &, const string &, Output_File &, Output_File &);
+
+template <unsigned int R>
+struct MCM_Kernel_Table {
+    static void fill(MCM_Kernel_t *Table)  {  Table[R] = &MCM_GivenRank_R_Kernel<R>;  MCM_Kernel_Table<R-1>::fill(Table);  }
+};
+template <>
+struct MCM_Kernel_Table<r_min_Specialized - 1> {
+    static void fill(MCM_Kernel_t *)  {  }
+};
+
+struct MCM_Kernels {
+    MCM_Kernel_t Kernel[r_max_Specialized + 1];
+    MCM_Kernels()  {  for (auto& K : Kernel)  {  K = NULL;  }  MCM_Kernel_Table<r_max_Specialized>::fill(Kernel);  }
+};
+
+/******************************************************************************/
+// *** Version 1 specialized on the rank:
+// ***            Same as MCM_GivenRank_r (same files, same output in the terminal), with the settings of Config
+// ***            (rank r = Config.r, print_bool, output directory and stream, progress report),
+// ***            with a kernel compiled for each rank 2 <= r <= 20 (see above);
+// ***            for the other values of r (or r > n), the search is done by a MCM_Search_Engine with the same settings.
+/******************************************************************************/
+map<uint32_t, uint32_t> MCM_GivenRank_r_Specialized(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, const MCM_Search_Config &Config)
+{
+  const unsigned int r = Config.r;
+  if (r < r_min_Specialized || r > r_max_Specialized || r > n)
+  {
+    MCM_Search_Engine Engine(Kset, N, Config);
+    return Engine.GivenRank_r(LogE_best);
+  }
+
+  static const MCM_Kernels Kernels;      // filled once, at the first call (thread-safe initialization of a local static)
+
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Search for the best MCM.." << endl << endl;
+
+  string xx_st = "";
+  for(unsigned int i=0; i<n-r; i++)
+    {  xx_st += "_";  }
+
+  // *** Print in file Best MCMs:
+  Output_File file_BestMCM;
+  if (Config.print_files)  {  file_BestMCM.open(Config.output_directory + "BestMCM_Rank_r=" + to_string(r) + ".dat");  }
+  file_BestMCM << "# 1:Partition \t 2:LogE " << endl;
+
+  // *** Print in file all MCMs:
+  Output_File file_MCM_Rank_r;
+  if (Config.print_files)  {  file_MCM_Rank_r.open(Config.output_directory + "AllMCMs_Rank_r" + to_string(r) + ".dat");  }
+  if(Config.print_bool)
+  {
+    out << "--> Print the LogE-value of all the MCM of rank r=" << r << " in the file '";
+    out << (Config.output_directory + "AllMCMs_Rank_r=" + to_string(r) + ".dat") << "'" << endl << endl;
+    file_MCM_Rank_r << "# 1:Partition \t 2:LogE \t 3:C_K \t 4:C_geom \t 5:C_tot \t 6:counter" << endl;
+  }
+  else
+  {
+    file_MCM_Rank_r << "To activate the prints for all the MCMs of rank r="<< r << ","<< endl;
+    file_MCM_Rank_r << " specify `print_bool=true` in the last argument of the function MCM_GivenRank_r();";
+  }
+
+  uint32_t aBest[r_max_Specialized];
+  unsigned long long counter = Kernels.Kernel[r](Kset, N, LogE_best, aBest, Config, xx_st, file_BestMCM, file_MCM_Rank_r);
+
+  file_BestMCM.close();
+  file_MCM_Rank_r.close();
+
+  out << "--> Number of MCModels (of rank r=" << r << ") that were compared: " << counter << " (Bell number B_" << r << " = " << Bell_numbers[r] << ")" << endl;
+
+  out << endl << "********** Best MCM: **********";
+  out << endl << "\t !! The first operator of the basis provided corresponds to the bit the most on the right !!";
+  out << endl << "\t !! The last operator corresponds to the bit the most on the left !!" << endl << endl;;
+
+  out << "\t >> Best Model = ";
+  out << xx_st;
+  for(unsigned int i=0; i<r; i++) {  out << aBest[i];  }
+  out << "\t \t LogE = " << (*LogE_best) << endl << endl;
+
+  return Convert_Partition_forMCM(aBest, r);
+}
+
+map<uint32_t, uint32_t> MCM_GivenRank_r_Specialized(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int r=n, bool print_bool=false)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  Config.print_bool = print_bool;
+  return MCM_GivenRank_r_Specialized(Kset, N, LogE_best, Config);
+}
@@ -0,0 +1,202 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+map<uint32_t, uint32_t> Convert_Partition_forMCM(uint32_t *a, unsigned int r);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+double LogE_ICC_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC, vector<pair<uint32_t, unsigned int>> &Buffer);
+vector<double> LogE_AllSubsets_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r);
+
+/******************************************************************************/
+/*****************   LogE of an ICC, by sorting the states   ******************/
+/******************************************************************************/
+// Same value as LogE_ICC(Kset, Ai, N), but the states of the ICC are counted by projecting the states of Kset on Ai
+// (Kset_ICC is a buffer, to avoid a new allocation at each call), instead of building a map;
+// the states of Kset don't need to be distinct.
+// The projected states are grouped in an array if the ICC is small, or by a radix sort otherwise (see ICC_Projection.cpp).
+// This function doesn't account of the contribution to LogE due to the non-modeled spins (i.e. N*log(2) per spin)
+
+double LogE_ICC_Sorted(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC)
+{
+  static thread_local vector<pair<uint32_t, unsigned int>> Buffer;      // second buffer of the radix sort
+  return LogE_ICC_Projected(Kset, Ai, N, Kset_ICC, Buffer);
+}
+
+/******************************************************************************/
+/*********************   LogE of ALL the possible ICCs   **********************/
+/******************************************************************************/
+// LogE_table[Ai] = LogE_ICC(Kset, Ai, N) for all the parts Ai of the r first basis elements (1 <= Ai < 2^r);
+// LogE_table[0] = 0.
+// The parts are not evaluated one by one: the histogram of a part is obtained from the histogram of a neighbouring part,
+// by the sparse method if |Kset| << 2^r or by the dense method otherwise (see ICC_Projection.cpp).
+
+vector<double> LogE_AllSubsets(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n)
+{
+  return LogE_AllSubsets_Projected(Kset, N, r);
+}
+
+/******************************************************************************/
+/*************  Best partition by DYNAMIC PROGRAMMING over SUBSETS   **********/
+/******************************************************************************/
+// *** Given the value of each possible part Ai of the r first basis elements (Score_table[Ai], for 1 <= Ai < 2^r),
+// *** returns the partition of the r elements that maximizes the sum of the values of its parts;
+// *** the maximum is stored in *Score_best.
+// *** Best[S] = max over the parts T of S containing the lowest element of S of:  Score_table[T] + Best[S - T]
+// *** --> goes through 3^r pairs (S, T), instead of the Bell(r) partitions of Algorithm H.
+// *** Parts with a value of -INFINITY are never selected (this can be used to exclude parts from the search).
+// *** The returned partition is written in the same format as for the other search functions (see Convert_Partition_forMCM).
+
+// *** Fills Best[S] and Best_Part[S] (= part of S containing its lowest element, in the best partition of S), for all S;
+// *** if a deadline is given, stops and returns false when the deadline is reached before the end.
+bool SubsetDP_Fill(const vector<double> &Score_table, unsigned int r, vector<double> &Best, vector<uint32_t> &Best_Part, const chrono::steady_clock::time_point *deadline = NULL)
+{
+  uint32_t Nsub = (1UL << r);
+  Best.assign(Nsub, -INFINITY);
+  Best_Part.assign(Nsub, 0);
+  Best[0] = 0;
+
+  uint32_t low = 0, rest = 0, sub = 0, T = 0;
+  double score = 0;
+
+  for (uint32_t S = 1; S < Nsub; S++)
+  {
+    if (deadline != NULL && (S & 1023) == 0 && chrono::steady_clock::now() > (*deadline))  {  return false;  }
+
+    low = S & (~S + 1);      // lowest element of S
+    rest = S ^ low;
+    sub = rest;
+    while (true)             // all the subsets "sub" of "rest"
+    {
+      T = sub | low;
+      score = Score_table[T] + Best[S ^ T];
+      if (score > Best[S])  {  Best[S] = score;  Best_Part[S] = T;  }
+      if (sub == 0)  {  break;  }
+      sub = (sub - 1) & rest;
+    }
+  }
+  return true;
+}
+
+// *** Best partition of the r elements, written in the format of Algorithm H (a[0] = last basis element):
+map<uint32_t, uint32_t> SubsetDP_Partition(const vector<uint32_t> &Best_Part, unsigned int r)
+{
+  vector<uint32_t> a(r, 0);
+  uint32_t S = (1UL << r) - 1, digit = 0;
+  vector<uint32_t> Parts;
+  while (S != 0 && Best_Part[S] != 0)  {  Parts.push_back(Best_Part[S]);  S ^= Best_Part[S];  }
+
+  vector<int> digit_of_Part(Parts.size(), -1);
+  for (unsigned int i=0; i<r; i++)
+  {
+    uint32_t element = (1UL << (r-1-i));
+    for (unsigned int k=0; k<Parts.size(); k++)
+    {
+      if (Parts[k] & element)
+      {
+        if (digit_of_Part[k] == -1)  {  digit_of_Part[k] = digit;  digit++;  }
+        a[i] = digit_of_Part[k];
+        break;
+      }
+    }
+  }
+
+  return Convert_Partition_forMCM(a.data(), r);
+}
+
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best)
+{
+  vector<double> Best;
+  vector<uint32_t> Best_Part;
+
+  SubsetDP_Fill(Score_table, r, Best, Best_Part);
+  *Score_best = Best[(1UL << r) - 1];
+
+  return SubsetDP_Partition(Best_Part, r);
+}
+
+/******************************************************************************/
+// *** Exhaustive search for the best MCM of rank r = Config.r (same result as Version 1, MCM_GivenRank_r),
+// *** using the dynamic programming over the 2^r possible parts:
+// *** nothing is printed in files.
+/******************************************************************************/
+map<uint32_t, uint32_t> MCM_GivenRank_r_SubsetDP(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, const MCM_Search_Config &Config)
+{
+  const unsigned int r = Config.r;
+  vector<double> LogE_table = LogE_AllSubsets(Kset, N, r);
+
+  map<uint32_t, uint32_t> Partition = MCM_SubsetDP(LogE_table, r, LogE_best);
+  (*LogE_best) -= ((double) (N * (n-r))) * log(2.);     // contribution of the non-modeled spins
+
+  return Partition;
+}
+
+map<uint32_t, uint32_t> MCM_GivenRank_r_SubsetDP(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int r=n)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_GivenRank_r_SubsetDP(Kset, N, LogE_best, Config);
+}
+
+/******************************************************************************/
+// *** Best MCM for all the ranks r = 1, ..., R = Config.r at once:
+// *** the MCMs of rank r are based on the r first elements of the basis, whose subsets are the parts Ai < 2^r;
+// *** the LogE of the 2^R possible ICCs is computed once, and a single dynamic programming pass gives the best partition
+// *** of every prefix of the basis (Best[2^r - 1]).
+// *** The best MCM of each rank is printed in the file "BestMCM_NestedRanks_R=....dat" (if Config.print_files).
+// *** Returns, for each rank r (at position r-1): (LogE of the best MCM of rank r, best MCM of rank r).
+/******************************************************************************/
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_NestedRanks(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const MCM_Search_Config &Config)
+{
+  const unsigned int R = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Search for the best MCM of each rank r = 1, ..., " << R << ".." << endl << endl;
+
+  vector<double> LogE_table = LogE_AllSubsets(Kset, N, R);
+  vector<double> Best;
+  vector<uint32_t> Best_Part;
+  SubsetDP_Fill(LogE_table, R, Best, Best_Part);
+
+  vector<pair<double, map<uint32_t, uint32_t>>> Results(R);
+
+  string filename = Config.output_directory + "BestMCM_NestedRanks_R=" + to_string(R) + ".dat";
+  Output_File file_Best;
+  if (Config.print_files)  {  file_Best.open(filename);  }
+  file_Best << "# 1:Rank r \t 2:Best MCM \t 3:LogE" << endl;
+
+  for (unsigned int r=1; r<=R; r++)
+  {
+    Results[r-1].first = Best[(1UL << r) - 1] - ((double) (N * (n-r))) * log(2.);     // contribution of the non-modeled spins
+    Results[r-1].second = SubsetDP_Partition(Best_Part, r);
+
+    file_Best << r << " \t" << Partition_to_String(Results[r-1].second, r) << " \t" << Results[r-1].first << endl;
+    out << "\t r = " << r << ": \t Best Model = " << Partition_to_String(Results[r-1].second, r) << "\t \t LogE = " << Results[r-1].first << endl;
+  }
+  file_Best.close();
+
+  if (Config.print_files)  {  out << endl << "--> Best MCMs printed in the file '" << filename << "'" << endl << endl;  }
+
+  return Results;
+}
+
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_NestedRanks(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int R=n)
+{
+  MCM_Search_Config Config;
+  Config.r = R;
+  return MCM_NestedRanks(Kset, N, Config);
+}
@@ -0,0 +1,189 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <map>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+/******************************************************************************/
+/*******************   BOOTSTRAP REPLICATES of the histogram   ****************/
+/******************************************************************************/
+// Multinomial resampling of the N datapoints from the empirical distribution Kset, for B replicates at once;
+// Counts are stored replicate-wise for each state: Kset_boot[i*B + b] = count of the state Kset[i].first in the replicate b.
+// The multinomial is sampled with successive conditional binomials.
+
+vector<unsigned int> Bootstrap_Kset(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int B, uint64_t seed = 1)
+{
+  unsigned int K = Kset.size();
+  vector<unsigned int> Kset_boot(((size_t) K) * B, 0);
+
+  for (unsigned int b=0; b<B; b++)
+  {
+    mt19937_64 gen(seed + b);
+    unsigned int N_left = N;    // datapoints left to draw
+    unsigned int Ns_left = N;   // datapoints of the original dataset in the remaining states
+
+    for (unsigned int i=0; i<K && N_left > 0; i++)
+    {
+      unsigned int ks = N_left;
+      if (Kset[i].second < Ns_left)
+      {
+        binomial_distribution<unsigned int> binomial(N_left, ((double) Kset[i].second) / Ns_left);
+        ks = binomial(gen);
+      }
+      Kset_boot[((size_t) i)*B + b] = ks;
+      N_left -= ks;
+      Ns_left -= Kset[i].second;
+    }
+  }
+
+  return Kset_boot;
+}
+
+/******************************************************************************/
+/***********   LogE of ALL the possible ICCs, for ALL the replicates  *********/
+/******************************************************************************/
+// LogE_table[Ai*B + b] = LogE of the ICC Ai for the replicate b, for 1 <= Ai < 2^r;
+// For each part Ai, the truncated states are grouped once (sort), and the B replicates are then counted and
+// evaluated together: the loops over the replicates are contiguous in memory and branch-free (vectorized by the compiler);
+// Rem: lgamma(0 + 1/2) = log(pi)/2, so with LogG[k] = lgamma(k+1/2) - log(pi)/2 the unobserved states of a replicate contribute 0.
+
+vector<double> LogE_AllSubsets_Bootstrap(const vector<pair<uint32_t, unsigned int>> &Kset, const vector<unsigned int> &Kset_boot, unsigned int N, unsigned int B, unsigned int r=n)
+{
+  uint32_t Nsub = (1UL << r);
+  unsigned int K = Kset.size();
+  vector<double> LogE_table(((size_t) Nsub) * B, 0);
+
+  // *** Tabulated values of lgamma(k+1/2) - log(pi)/2, for 0 <= k <= N:
+  vector<double> LogG(N+1);
+  for (unsigned int k=0; k<=N; k++)  {  LogG[k] = lgamma(k + 0.5) - 0.5 * log(M_PI);  }
+
+  vector<pair<uint32_t, unsigned int>> sig_ICC(K);   // (truncated state, index in Kset)
+  vector<unsigned int> Ks(B);                        // counts of a state of the ICC in each replicate
+  uint32_t m = 0;
+
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+  {
+    for (unsigned int i=0; i<K; i++)  {  sig_ICC[i] = make_pair(Kset[i].first & Ai, i);  }
+    sort(sig_ICC.begin(), sig_ICC.end());
+
+    double *LogE = &LogE_table[((size_t) Ai)*B];
+
+    for (unsigned int i=0; i<K; )
+    {
+      uint32_t s = sig_ICC[i].first;
+      fill(Ks.begin(), Ks.end(), 0);
+      for ( ; i<K && sig_ICC[i].first == s; i++)
+      {
+        const unsigned int *ks_boot = &Kset_boot[((size_t) sig_ICC[i].second)*B];
+        for (unsigned int b=0; b<B; b++)  {  Ks[b] += ks_boot[b];  }
+      }
+      for (unsigned int b=0; b<B; b++)  {  LogE[b] += LogG[Ks[b]];  }
+    }
+
+    m = bitset<n>(Ai).count();
+    double Cst = lgamma((double)( 1UL << (m-1) )) - lgamma( (double)( N + (1UL << (m-1)) ) );
+    for (unsigned int b=0; b<B; b++)  {  LogE[b] += Cst;  }
+  }
+
+  return LogE_table;
+}
+
+/******************************************************************************/
+/*************************    BOOTSTRAP of the BEST MCM   *********************/
+/******************************************************************************/
+// *** Search for the best MCM of rank r = Config.r in B bootstrap replicates of the data, and report how stable the best MCM is:
+// ***    -- "Bootstrap_B=..._Rank_r=..._Partitions.dat": each best MCM found, with the fraction of replicates in which it wins;
+// ***    -- "Bootstrap_B=..._Rank_r=..._Pairs.dat": for each pair of basis operators, the fraction of replicates
+// ***                                                  in which the two operators are in the same ICC of the best MCM.
+// *** (the files are printed in Config.output_directory if Config.print_files).
+// *** Returns the MCM that wins most often (its frequency is stored in *Freq_best).
+
+map<uint32_t, uint32_t> MCM_Bootstrap(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *Freq_best, unsigned int B, const MCM_Search_Config &Config, uint64_t seed=1)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Bootstrap of the best MCM of rank r=" << r << " (B=" << B << " replicates).." << endl << endl;
+
+  uint32_t Nsub = (1UL << r);
+
+  vector<unsigned int> Kset_boot = Bootstrap_Kset(Kset, N, B, seed);
+  vector<double> LogE_table = LogE_AllSubsets_Bootstrap(Kset, Kset_boot, N, B, r);
+
+  map<string, pair<unsigned int, map<uint32_t, uint32_t>>> Wins;   // partition --> (number of wins, partition)
+  vector<vector<unsigned int>> Pairs(r, vector<unsigned int>(r, 0));
+  vector<double> LogE_replicate(Nsub, 0);
+  double LogE_best = 0;
+
+  for (unsigned int b=0; b<B; b++)
+  {
+    for (uint32_t Ai = 1; Ai < Nsub; Ai++)  {  LogE_replicate[Ai] = LogE_table[((size_t) Ai)*B + b];  }
+    map<uint32_t, uint32_t> Partition = MCM_SubsetDP(LogE_replicate, r, &LogE_best);
+
+    pair<unsigned int, map<uint32_t, uint32_t>> &Win = Wins[Partition_to_String(Partition, r)];
+    Win.first++;   Win.second = Partition;
+
+    for (auto const& Part : Partition)
+      for (unsigned int i=0; i<r; i++)
+        for (unsigned int j=0; j<r; j++)
+          {  if ( ((Part.second >> i) & 1) && ((Part.second >> j) & 1) )  {  Pairs[i][j]++;  }  }
+  }
+
+  // *** Print winning partitions, by decreasing frequency:
+  vector<pair<unsigned int, string>> Wins_sorted;
+  for (auto const& Win : Wins)  {  Wins_sorted.push_back(make_pair(Win.second.first, Win.first));  }
+  sort(Wins_sorted.rbegin(), Wins_sorted.rend());
+
+  string filename = Config.output_directory + "Bootstrap_B=" + to_string(B) + "_Rank_r=" + to_string(r);
+
+  Output_File file_Partitions;
+  if (Config.print_files)  {  file_Partitions.open(filename + "_Partitions.dat");  }
+  file_Partitions << "# 1:Partition \t 2:Frequency \t 3:Number of wins" << endl;
+  for (auto const& Win : Wins_sorted)
+    {  file_Partitions << Win.second << " \t" << ((double) Win.first) / B << " \t" << Win.first << endl;  }
+  file_Partitions.close();
+
+  // *** Print frequency of each pair of operators in the same ICC:
+  Output_File file_Pairs;
+  if (Config.print_files)  {  file_Pairs.open(filename + "_Pairs.dat");  }
+  file_Pairs << "# Fraction of the replicates in which the operators Op_i (row) and Op_j (column) belong to the same ICC of the best MCM" << endl;
+  for (unsigned int i=0; i<r; i++)
+  {
+    for (unsigned int j=0; j<r; j++)  {  file_Pairs << ((double) Pairs[i][j]) / B << " \t";  }
+    file_Pairs << endl;
+  }
+  file_Pairs.close();
+
+  out << "--> Number of different best MCMs among the " << B << " replicates: " << Wins_sorted.size() << endl;
+  if (Config.print_files)  {  out << "--> Frequencies printed in the files '" << filename << "_Partitions.dat' and '" << filename << "_Pairs.dat'" << endl;  }
+  out << endl;
+
+  if (Wins_sorted.empty())  {  *Freq_best = 0;  return map<uint32_t, uint32_t>();  }
+
+  *Freq_best = ((double) Wins_sorted[0].first) / B;
+  out << "\t >> Most frequent best Model = " << Wins_sorted[0].second << "\t \t Frequency = " << (*Freq_best) << endl << endl;
+
+  return Wins[Wins_sorted[0].second].second;
+}
+
+map<uint32_t, uint32_t> MCM_Bootstrap(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *Freq_best, unsigned int B=100, unsigned int r=n, uint64_t seed=1)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_Bootstrap(Kset, N, Freq_best, B, Config, seed);
+}
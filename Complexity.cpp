@@ -5,6 +5,7 @@
 using namespace std;
 
 #include "data.h"
+#include "partition.h"
 
 
 /******************************************************************************/
@@ -31,14 +32,14 @@ double ParamComplexity_ICC(unsigned int m, unsigned int N)  // Parameter Complex
 // Compute separately: -- the first order complexity    --> stored in C_param
 //                     -- and the geometric complexity  --> stored in C_geom
 
-double Complexity_MCM(map<uint32_t, uint32_t> Partition, unsigned int N, double *C_param, double *C_geom)
+double Complexity_MCM(const Partition_t &Partition, unsigned int N, double *C_param, double *C_geom)
 {
   *C_param = 0;   *C_geom = 0;
   uint32_t m_i = 0;  // number of elements in Ai
 
-  for (map<uint32_t, uint32_t>::iterator Part = Partition.begin(); Part != Partition.end(); Part++)
+  for (unsigned int k=0; k<Partition.size; k++)
   {
-    m_i = bitset<n>((*Part).second).count();
+    m_i = bitset<n>(Partition.Part[k]).count();
     (*C_param) += ParamComplexity_ICC(m_i, N);
     (*C_geom) += GeomComplexity_ICC(m_i);
   }  
@@ -46,3 +47,7 @@ double Complexity_MCM(map<uint32_t, uint32_t> Partition, unsigned int N, double
   return (*C_param) + (*C_geom);
 }
 
+double Complexity_MCM(map<uint32_t, uint32_t> Partition, unsigned int N, double *C_param, double *C_geom)
+{
+  return Complexity_MCM(Partition_from_map(Partition), N, C_param, C_geom);
+}
@@ -0,0 +1,183 @@
+#include <iostream>
+#include <list>
+#include <map>
+#include <vector>
+#include <cmath>
+#include <thread>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+uint32_t transform_mu_basis(uint32_t mu, list<uint32_t> basis);
+
+double LogL_MCM_HeldOut(const vector<pair<uint32_t, unsigned int>> &Kset_train, unsigned int N_train, const vector<pair<uint32_t, unsigned int>> &Kset_test, unsigned int N_test, map<uint32_t, uint32_t> Partition);
+
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_TopCandidates(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int n_top, unsigned int r);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+/******************************************************************************/
+/**********************    ASSIGN a DATAPOINT to a FOLD   *********************/
+/******************************************************************************/
+// The d-th datapoint of the dataset (datapoints ordered by state, as in Nset) is assigned to a fold with a hash of (d, seed):
+// the assignment is random-like, reproducible, and doesn't need to store a permutation of the N datapoints.
+unsigned int Fold_of_Datapoint(uint64_t d, uint64_t seed, unsigned int k_folds)
+{
+  uint64_t z = d + seed * 0x9E3779B97F4A7C15ULL;  // splitmix64
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+  return (unsigned int) (z % k_folds);
+}
+
+/******************************************************************************/
+/*****************    SPLIT the DATA in k FOLDS (held-out sets)   *************/
+/******************************************************************************/
+// Split the datapoints in k folds and return, for each fold, the histogram of the held-out datapoints written in the new basis;
+// The change of basis is done only once per observed state.
+// N_fold[f] = number of datapoints in fold f.
+
+vector<vector<pair<uint32_t, unsigned int>>> build_Kset_Folds(const vector<pair<uint32_t, unsigned int>> &Nset, list<uint32_t> Basis, unsigned int k_folds, vector<unsigned int> &N_fold, uint64_t seed = 1)
+{
+  vector<map<uint32_t, unsigned int>> Kset_fold_map(k_folds);
+  N_fold.assign(k_folds, 0);
+
+  uint64_t d = 0;       // index of the datapoint
+  uint32_t sig_m = 0;   // transformed state
+  vector<unsigned int> ks_fold(k_folds, 0);
+
+  for (auto const& it : Nset)
+  {
+    sig_m = transform_mu_basis((it).first, Basis);   // transform the state s=(it).first into the new basis
+
+    for (unsigned int f=0; f<k_folds; f++)  {  ks_fold[f] = 0;  }
+    for (unsigned int i=0; i<(it).second; i++, d++)  {  ks_fold[Fold_of_Datapoint(d, seed, k_folds)]++;  }
+
+    for (unsigned int f=0; f<k_folds; f++)
+    {
+      if (ks_fold[f] != 0)  {  Kset_fold_map[f][sig_m] += ks_fold[f];  N_fold[f] += ks_fold[f];  }
+    }
+  }
+
+  // convert maps to vectors
+  vector<vector<pair<uint32_t, unsigned int>>> Kset_fold(k_folds);
+  for (unsigned int f=0; f<k_folds; f++)
+  {
+    Kset_fold[f].assign(Kset_fold_map[f].begin(), Kset_fold_map[f].end());
+  }
+
+  return Kset_fold;
+}
+
+/******************************************************************************/
+/*******************    TRAINING SET = FULL DATA - HELD-OUT SET   *************/
+/******************************************************************************/
+// Kset and Kset_test are both sorted by state (as returned by build_Kset and build_Kset_Folds),
+// and Kset_test must be a sub-histogram of Kset:
+vector<pair<uint32_t, unsigned int>> Subtract_Kset(const vector<pair<uint32_t, unsigned int>> &Kset, const vector<pair<uint32_t, unsigned int>> &Kset_test)
+{
+  vector<pair<uint32_t, unsigned int>> Kset_train;
+  Kset_train.reserve(Kset.size());
+
+  vector<pair<uint32_t, unsigned int>>::const_iterator it_test = Kset_test.begin();
+
+  for (auto const& it : Kset)
+  {
+    unsigned int ks = (it).second;
+    if (it_test != Kset_test.end() && (it_test->first) == (it).first)  {  ks -= (it_test->second);  it_test++;  }
+    if (ks != 0)  {  Kset_train.push_back(make_pair((it).first, ks));  }
+  }
+
+  return Kset_train;
+}
+
+/******************************************************************************/
+/**************************   k-FOLD CROSS-VALIDATION   ***********************/
+/******************************************************************************/
+// *** Compare the `n_top` best MCMs of rank r = Config.r (according to LogE on the full dataset) with k-fold cross-validation:
+// ***    for each fold, the parameters of the MCM are learned on the other (k-1) folds,
+// ***    and the log-likelihood of the MCM is computed on the held-out fold.
+// *** The data is read and transformed only once; the k folds are evaluated in parallel (one thread per fold).
+// *** Results are printed in Config.out and in the file "CrossValidation_k=..._Rank_r=....dat" (if Config.print_files);
+// *** the function returns the MCM with the largest held-out LogL (summed over the k folds).
+
+map<uint32_t, uint32_t> MCM_CrossValidation(const vector<pair<uint32_t, unsigned int>> &Nset, list<uint32_t> Basis, const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogL_test_best, unsigned int k_folds, unsigned int n_top, const MCM_Search_Config &Config, uint64_t seed=1)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Cross-validation of the " << n_top << " best MCMs of rank r=" << r << " (k=" << k_folds << " folds).." << endl << endl;
+
+  // *** Candidate MCMs:
+  vector<pair<double, map<uint32_t, uint32_t>>> Candidates = MCM_GivenRank_r_TopCandidates(Kset, N, n_top, r);
+
+  // *** Split the data in k folds:
+  vector<unsigned int> N_fold;
+  vector<vector<pair<uint32_t, unsigned int>>> Kset_fold = build_Kset_Folds(Nset, Basis, k_folds, N_fold, seed);
+
+  // *** Held-out LogL of each candidate in each fold --> LogL_test[f][c]:
+  vector<vector<double>> LogL_test(k_folds, vector<double>(Candidates.size(), 0));
+  vector<thread> Threads;
+
+  for (unsigned int f=0; f<k_folds; f++)
+  {
+    Threads.push_back(thread([&, f]()
+    {
+      vector<pair<uint32_t, unsigned int>> Kset_train = Subtract_Kset(Kset, Kset_fold[f]);
+      for (unsigned int c=0; c<Candidates.size(); c++)
+        {  LogL_test[f][c] = LogL_MCM_HeldOut(Kset_train, N - N_fold[f], Kset_fold[f], N_fold[f], Candidates[c].second);  }
+    }));
+  }
+  for (auto& t : Threads)  {  t.join();  }
+
+  // *** Print results:
+  Output_File file_CV;
+  if (Config.print_files)  {  file_CV.open(Config.output_directory + "CrossValidation_k=" + to_string(k_folds) + "_Rank_r=" + to_string(r) + ".dat");  }
+  file_CV << "# 1:Partition \t 2:LogE \t 3:LogL_test (sum over folds) \t 4:LogL_test per datapoint \t 5:std over folds (per datapoint)" << endl;
+
+  out << "## 1:Partition \t 2:LogE \t 3:LogL_test \t 4:LogL_test/N \t 5:std" << endl;
+
+  unsigned int c_best = 0;
+  *LogL_test_best = 0;
+
+  for (unsigned int c=0; c<Candidates.size(); c++)
+  {
+    double LogL_sum = 0, mean = 0, var = 0;
+    unsigned int k_nonempty = 0;   // number of non-empty folds
+    for (unsigned int f=0; f<k_folds; f++)
+    {
+      if (N_fold[f] == 0)  {  continue;  }
+      LogL_sum += LogL_test[f][c];  mean += LogL_test[f][c] / N_fold[f];  k_nonempty++;
+    }
+    mean /= k_nonempty;
+    for (unsigned int f=0; f<k_folds; f++)  {  if (N_fold[f] != 0)  {  var += pow(LogL_test[f][c] / N_fold[f] - mean, 2);  }  }
+    var = (k_nonempty > 1) ? var / (k_nonempty - 1) : 0;
+
+    string Partition_st = Partition_to_String(Candidates[c].second, r);
+    file_CV << Partition_st << " \t" << Candidates[c].first << " \t" << LogL_sum << " \t" << LogL_sum / N << " \t" << sqrt(var) << endl;
+    out << " \t" << Partition_st << " \t" << Candidates[c].first << " \t" << LogL_sum << " \t" << LogL_sum / N << " \t" << sqrt(var) << endl;
+
+    if (c == 0 || LogL_sum > (*LogL_test_best))  {  *LogL_test_best = LogL_sum;  c_best = c;  }
+  }
+  file_CV.close();
+
+  if (Candidates.empty())  {  return map<uint32_t, uint32_t>();  }
+
+  out << endl << "\t >> Best Model (held-out LogL) = " << Partition_to_String(Candidates[c_best].second, r);
+  out << "\t \t LogL_test = " << (*LogL_test_best) << endl << endl;
+
+  return Candidates[c_best].second;
+}
+
+map<uint32_t, uint32_t> MCM_CrossValidation(const vector<pair<uint32_t, unsigned int>> &Nset, list<uint32_t> Basis, const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogL_test_best, unsigned int k_folds=5, unsigned int n_top=10, unsigned int r=n, uint64_t seed=1)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_CrossValidation(Nset, Basis, Kset, N, LogL_test_best, k_folds, n_top, Config, seed);
+}
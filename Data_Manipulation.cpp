@@ -10,6 +10,7 @@
 /**************************    CONSTANTS    *************************/
 /********************************************************************/
 #include "data.h"
+#include "profiling.h"
 
 /******************************************************************************/
 /**************************     READ FILE    **********************************/
@@ -17,12 +18,14 @@
 /**************    READ DATA and STORE them in Nset    ************************/
 vector<pair<uint32_t, unsigned int>> read_datafile(unsigned int *N, string filename = datafilename)    // O(N)  where N = data set size
 {
+  Profile_Timer Timer("read_datafile");
   string line, line2;     uint32_t state = 0;
   (*N) = 0;            // N = dataset size
   cout << endl << "--->> Read \"" << filename << "\",\t Build Nset...";
 
 // ***** data are store in Nset:  ********************************
   map<uint32_t, unsigned int> Nset_map; // Nset[mu] = #of time state mu appears in the data set
+  Profile_Count(PROF_MAP_ALLOCATIONS);
   
   ifstream myfile (filename.c_str());
   if (myfile.is_open())
@@ -54,6 +57,33 @@ vector<pair<uint32_t, unsigned int>> read_datafile(unsigned int *N, string filen
   return Nset;
 }
 
+/**************    READ DATA in the ORDER of the FILE    **********************/
+// Same as read_datafile, but keeps the datapoints in the order in which they appear in the file (e.g. for time series):
+vector<uint32_t> read_datafile_rows(unsigned int *N, string filename = datafilename)    // O(N)  where N = data set size
+{
+  Profile_Timer Timer("read_datafile_rows");
+  string line, line2;
+  vector<uint32_t> Rows;
+  cout << endl << "--->> Read \"" << filename << "\",\t Build the list of datapoints...";
+
+  ifstream myfile (filename.c_str());
+  if (myfile.is_open())
+  {
+    while ( getline (myfile,line))
+    {
+      line2 = line.substr (0,n);          //take the n first characters of line
+      Rows.push_back(bitset<n>(line2).to_ulong());   //convert string line2 into a binary integer
+    }
+    myfile.close();
+  }
+  else cout << "Unable to open file"; 
+
+  (*N) = Rows.size();
+  cout << "\t\t data size N = " << (*N) << endl;
+
+  return Rows;
+}
+
 /******************************************************************************/
 /*********************     CHANGE of BASIS: one datapoint  ********************/
 /******************************************************************************/
@@ -88,7 +118,9 @@ vector<pair<uint32_t, unsigned int>> build_Kset(vector<pair<uint32_t, unsigned i
 // sig_m = sig in the new basis and cut on the m first spins 
 // Kset[sig_m] = #of time state mu_m appears in the data set
 {
+  Profile_Timer Timer("build_Kset");
   map<uint32_t, unsigned int> Kset_map;
+  Profile_Count(PROF_MAP_ALLOCATIONS);
   uint32_t sig_m;    // transformed state and to the m first spins
 
   cout << endl << "--->> Build Kset..." << endl;
@@ -0,0 +1,269 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <list>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>      /* open */
+#include <unistd.h>     /* close, ftruncate */
+#include <sys/file.h>   /* flock */
+#include <sys/mman.h>   /* mmap */
+#include <sys/stat.h>   /* fstat */
+
+using namespace std;
+
+#include "data.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+uint32_t transform_mu_basis(uint32_t mu, list<uint32_t> basis);
+vector<uint32_t> ICC_Operators(const vector<uint32_t> &Basis_vec, uint32_t Ai);
+
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best);
+
+/******************************************************************************/
+/**********************   PERSISTENT CACHE: FILE FORMAT   *********************/
+/******************************************************************************/
+// The cache file is a hash table with a fixed number of slots (chosen when the file is created), mapped in memory.
+// Each entry is identified by a 128-bit key, which is a hash of:
+//    - the fingerprint of the dataset (see Dataset_Fingerprint), and
+//    - the set of operators of the ICC, written in the original basis of the data (see ICC_Operators);
+// so that an ICC is found again with any basis containing its operators, and with any rank.
+// Each entry stores the LogE and the LogL of the ICC (see LogE_ICC and LogL_ICC), and its number of observed states.
+// Several programs can use the same file at the same time: the file is read under a shared lock,
+// and the new entries are written under an exclusive lock (flock). When the table is full, new entries are not stored.
+
+const uint64_t ICC_Cache_magic = 0x4D434D4343414348ULL;   // "MCMCCACH"
+
+struct ICC_Cache_Header {
+    uint64_t magic;
+    uint64_t capacity;        // number of slots (power of 2)
+    uint64_t count;           // number of slots used
+};
+
+struct ICC_Cache_Slot {
+    uint64_t key_hi;
+    uint64_t key_lo;          // key_hi = key_lo = 0: empty slot
+    double LogE;
+    double LogL;
+    uint64_t K;               // number of observed states of the ICC
+};
+
+uint64_t Mix64(uint64_t x)     // splitmix64 finalizer
+{
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// *** Fingerprint of the dataset: hash of n, N and of all the (state, count) of Nset:
+uint64_t Dataset_Fingerprint(const vector<pair<uint32_t, unsigned int>> &Nset)
+{
+  vector<pair<uint32_t, unsigned int>> Nset_sorted(Nset);
+  sort(Nset_sorted.begin(), Nset_sorted.end());
+
+  uint64_t h = Mix64(n);
+  for (auto const& s : Nset_sorted)  {  h = Mix64(h ^ ((((uint64_t) s.first) << 32) | s.second));  }
+  return h;
+}
+
+void ICC_Cache_Key(uint64_t fingerprint, const vector<uint32_t> &Ops, uint64_t *key_hi, uint64_t *key_lo)
+{
+  uint64_t h1 = Mix64(fingerprint ^ 0x5851F42D4C957F2DULL), h2 = Mix64(fingerprint ^ 0x14057B7EF767814FULL);
+  for (auto const& Op : Ops)  {  h1 = Mix64(h1 ^ Op);  h2 = Mix64(h2 + Op);  }
+  h1 = Mix64(h1 ^ Ops.size());
+  if (h1 == 0 && h2 == 0)  {  h2 = 1;  }
+  *key_hi = h1;  *key_lo = h2;
+}
+
+/******************************************************************************/
+/*************************   OPEN / CLOSE the CACHE   *************************/
+/******************************************************************************/
+struct ICC_Cache_File {
+    int fd = -1;
+    size_t size = 0;
+    ICC_Cache_Header *Header = NULL;
+    ICC_Cache_Slot *Slots = NULL;
+};
+
+// *** Open (or create, with 2^log2_capacity slots) the cache file; returns false if the file can't be used:
+bool ICC_Cache_Open(string cache_filename, unsigned int log2_capacity, ICC_Cache_File *Cache)
+{
+  Cache->fd = open(cache_filename.c_str(), O_RDWR | O_CREAT, 0644);
+  if (Cache->fd < 0)  {  cout << "Unable to open the cache file \"" << cache_filename << "\"" << endl;  return false;  }
+
+  // *** Initialisation of a new file (only by one program):
+  flock(Cache->fd, LOCK_EX);
+  struct stat st;
+  fstat(Cache->fd, &st);
+  if (st.st_size == 0)
+  {
+    ICC_Cache_Header Header = {ICC_Cache_magic, (1ULL << log2_capacity), 0};
+    if (ftruncate(Cache->fd, sizeof(ICC_Cache_Header) + Header.capacity * sizeof(ICC_Cache_Slot)) != 0 ||
+        pwrite(Cache->fd, &Header, sizeof(Header), 0) != (ssize_t) sizeof(Header))
+    {
+      cout << "Unable to initialise the cache file \"" << cache_filename << "\"" << endl;
+      flock(Cache->fd, LOCK_UN);  close(Cache->fd);  Cache->fd = -1;
+      return false;
+    }
+    fstat(Cache->fd, &st);
+  }
+  flock(Cache->fd, LOCK_UN);
+
+  Cache->size = st.st_size;
+  void *map_addr = mmap(NULL, Cache->size, PROT_READ | PROT_WRITE, MAP_SHARED, Cache->fd, 0);
+  if (map_addr == MAP_FAILED)  {  close(Cache->fd);  Cache->fd = -1;  return false;  }
+
+  Cache->Header = (ICC_Cache_Header *) map_addr;
+  Cache->Slots = (ICC_Cache_Slot *) ((char *) map_addr + sizeof(ICC_Cache_Header));
+
+  if (Cache->Header->magic != ICC_Cache_magic || Cache->size != sizeof(ICC_Cache_Header) + Cache->Header->capacity * sizeof(ICC_Cache_Slot))
+  {
+    cout << "The file \"" << cache_filename << "\" is not a valid cache file" << endl;
+    munmap(map_addr, Cache->size);  close(Cache->fd);  Cache->fd = -1;
+    return false;
+  }
+  return true;
+}
+
+void ICC_Cache_Close(ICC_Cache_File *Cache)
+{
+  if (Cache->fd < 0)  {  return;  }
+  munmap((void *) Cache->Header, Cache->size);
+  close(Cache->fd);
+  Cache->fd = -1;
+}
+
+// *** Slot of the key (linear probing): either the slot containing the key, or the empty slot where it should be inserted;
+// *** returns NULL if the key is not in the table and the table is full:
+ICC_Cache_Slot *ICC_Cache_Find(ICC_Cache_File *Cache, uint64_t key_hi, uint64_t key_lo)
+{
+  uint64_t mask = Cache->Header->capacity - 1;
+  for (uint64_t i = 0, pos = key_hi & mask; i <= mask; i++, pos = (pos + 1) & mask)
+  {
+    ICC_Cache_Slot *Slot = &Cache->Slots[pos];
+    if ((Slot->key_hi == key_hi && Slot->key_lo == key_lo) || (Slot->key_hi == 0 && Slot->key_lo == 0))  {  return Slot;  }
+  }
+  return NULL;
+}
+
+/******************************************************************************/
+/****************   LogE, LogL and K of an ICC in a SINGLE PASS   *************/
+/******************************************************************************/
+void ICC_Stats_Sorted(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC, double *LogE, double *LogL, uint64_t *K)
+{
+  Kset_ICC.resize(Kset.size());
+  for (unsigned int i=0; i<Kset.size(); i++)  {  Kset_ICC[i] = make_pair(Kset[i].first & Ai, Kset[i].second);  }
+  sort(Kset_ICC.begin(), Kset_ICC.end());
+
+  uint32_t m = bitset<n>(Ai).count();
+  double Nd = N;
+  *LogE = 0;  *LogL = 0;  *K = 0;
+
+  for (unsigned int i=0; i<Kset_ICC.size(); )
+  {
+    unsigned int Ks = 0;
+    uint32_t s = Kset_ICC[i].first;
+    for ( ; i<Kset_ICC.size() && Kset_ICC[i].first == s; i++)  {  Ks += Kset_ICC[i].second;  }
+    (*LogE) += lgamma(Ks + 0.5);
+    (*LogL) += Ks * log((double) Ks / Nd);
+    (*K)++;
+  }
+  (*LogE) += lgamma((double)( 1UL << (m-1) )) - ((*K)/2.) * log(M_PI) - lgamma( (double)( N + (1UL << (m-1)) ) );
+}
+
+/******************************************************************************/
+/**************   LogE of ALL the ICCs, with the PERSISTENT CACHE   ***********/
+/******************************************************************************/
+// *** Same as LogE_AllSubsets, for the data Nset (written in the original basis) in the basis `Basis`;
+// *** the ICCs found in the cache file are not recomputed, and the others are added to the cache file;
+// *** if LogL_table is given, LogL_table[Ai] = LogL_ICC of the part Ai.
+// *** If the cache file can't be used, all the ICCs are computed.
+
+vector<double> LogE_AllSubsets_PersistentCache(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, list<uint32_t> Basis, string cache_filename, unsigned int r=n, vector<double> *LogL_table=NULL, unsigned int log2_capacity=20)
+{
+  vector<uint32_t> Basis_vec(Basis.begin(), Basis.end());
+  if (r > Basis_vec.size())  {  r = Basis_vec.size();  }
+  Basis_vec.resize(r);
+
+  uint32_t Nsub = (1UL << r);
+  vector<double> LogE_table(Nsub, 0);
+  if (LogL_table != NULL)  {  LogL_table->assign(Nsub, 0);  }
+
+  uint64_t fingerprint = Dataset_Fingerprint(Nset);
+  vector<uint64_t> Key_hi(Nsub, 0), Key_lo(Nsub, 0);
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)  {  ICC_Cache_Key(fingerprint, ICC_Operators(Basis_vec, Ai), &Key_hi[Ai], &Key_lo[Ai]);  }
+
+  ICC_Cache_File Cache;
+  bool cache_ok = ICC_Cache_Open(cache_filename, log2_capacity, &Cache);
+
+  // *** 1) Read the ICCs available in the cache:
+  vector<uint32_t> Missing;
+  if (cache_ok)  {  flock(Cache.fd, LOCK_SH);  }
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+  {
+    ICC_Cache_Slot *Slot = cache_ok ? ICC_Cache_Find(&Cache, Key_hi[Ai], Key_lo[Ai]) : NULL;
+    if (Slot != NULL && Slot->key_hi == Key_hi[Ai] && Slot->key_lo == Key_lo[Ai])
+    {
+      LogE_table[Ai] = Slot->LogE;
+      if (LogL_table != NULL)  {  (*LogL_table)[Ai] = Slot->LogL;  }
+    }
+    else  {  Missing.push_back(Ai);  }
+  }
+  if (cache_ok)  {  flock(Cache.fd, LOCK_UN);  }
+
+  if (Missing.empty())  {  ICC_Cache_Close(&Cache);  return LogE_table;  }
+
+  // *** 2) Compute the missing ICCs (without lock):
+  vector<pair<uint32_t, unsigned int>> Kset(Nset.size()), Kset_ICC;
+  list<uint32_t> Basis_r(Basis_vec.begin(), Basis_vec.end());
+  for (unsigned int i=0; i<Nset.size(); i++)  {  Kset[i] = make_pair(transform_mu_basis(Nset[i].first, Basis_r), Nset[i].second);  }
+
+  vector<double> LogL_missing(Missing.size());
+  vector<uint64_t> K_missing(Missing.size());
+  for (unsigned int k=0; k<Missing.size(); k++)
+  {
+    uint32_t Ai = Missing[k];
+    ICC_Stats_Sorted(Kset, Ai, N, Kset_ICC, &LogE_table[Ai], &LogL_missing[k], &K_missing[k]);
+    if (LogL_table != NULL)  {  (*LogL_table)[Ai] = LogL_missing[k];  }
+  }
+
+  // *** 3) Store them in the cache:
+  if (cache_ok)
+  {
+    flock(Cache.fd, LOCK_EX);
+    for (unsigned int k=0; k<Missing.size(); k++)
+    {
+      uint32_t Ai = Missing[k];
+      ICC_Cache_Slot *Slot = ICC_Cache_Find(&Cache, Key_hi[Ai], Key_lo[Ai]);
+      if (Slot == NULL || (Slot->key_hi == Key_hi[Ai] && Slot->key_lo == Key_lo[Ai]))  {  continue;  }   // full, or added by another program
+
+      Slot->LogE = LogE_table[Ai];  Slot->LogL = LogL_missing[k];  Slot->K = K_missing[k];
+      Slot->key_lo = Key_lo[Ai];  Slot->key_hi = Key_hi[Ai];
+      Cache.Header->count++;
+    }
+    msync((void *) Cache.Header, Cache.size, MS_ASYNC);
+    flock(Cache.fd, LOCK_UN);
+  }
+  ICC_Cache_Close(&Cache);
+
+  return LogE_table;
+}
+
+// *** Best MCM of rank r in the basis `Basis` (dynamic programming over subsets), with the LogE of the ICCs read from,
+// *** or added to, the cache file; nothing else is printed:
+map<uint32_t, uint32_t> MCM_GivenRank_r_PersistentCache(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, list<uint32_t> Basis, double *LogE_best, string cache_filename, unsigned int r=n)
+{
+  if (r > Basis.size())  {  r = Basis.size();  }
+  vector<double> LogE_table = LogE_AllSubsets_PersistentCache(Nset, N, Basis, cache_filename, r);
+
+  map<uint32_t, uint32_t> Partition = MCM_SubsetDP(LogE_table, r, LogE_best);
+  (*LogE_best) -= ((double) (N * (n-r))) * log(2.);     // contribution of the non-modeled spins
+
+  return Partition;
+}
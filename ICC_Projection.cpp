@@ -0,0 +1,258 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#include "data.h"
+#include "profiling.h"
+
+/******************************************************************************/
+/*********************   PROJECTION of Kset on an ICC   ***********************/
+/******************************************************************************/
+// To compute the LogE of an ICC Ai, the states of Kset are projected on Ai (s & Ai), and the counts of the equal projected states are added.
+// Two ways to group the projected states, chosen automatically:
+// ***   - dense:  if the ICC has few possible states (2^m <= |Kset|), the counts are added in an array of 2^m values;
+// ***   - sparse: otherwise, the projected states are sorted by a radix sort (only on the bytes of the states where Ai has bits).
+// In both cases, the states of the ICC are visited in increasing order, so that the LogE is the same (to the last bit) as LogE_ICC.
+
+// *** LogE of an ICC from the counts Ks of its observed states (visited in increasing order of the states):
+inline double LogE_ICC_from_Counts(double Sum_lgamma, unsigned int K_ICC, uint32_t m, unsigned int N)
+{
+  return Sum_lgamma + lgamma((double)( 1UL << (m-1) )) - (K_ICC/2.) * log(M_PI) - lgamma( (double)( N + (1UL << (m-1)) ) );
+}
+
+// *** Index of the projected state (s & Ai) in a dense array of 2^m values (bits of s selected by Ai, packed on m bits):
+inline uint32_t Pack_Bits(uint32_t s, uint32_t Ai)
+{
+  uint32_t index = 0, bit = 1;
+  for ( ; Ai != 0; Ai &= (Ai - 1), bit <<= 1)
+    {  if (s & Ai & (~Ai + 1))  {  index |= bit;  }  }
+  return index;
+}
+
+// *** LSD radix sort of the pairs (projected state, count) on the bytes of the states where the mask Ai has bits;
+// *** `Buffer` has the same size as `Kset_ICC` (the result is in Kset_ICC):
+void Radix_Sort_States(vector<pair<uint32_t, unsigned int>> &Kset_ICC, vector<pair<uint32_t, unsigned int>> &Buffer, uint32_t Ai)
+{
+  unsigned int Count[256];
+
+  for (unsigned int shift = 0; shift < 32; shift += 8)
+  {
+    if (((Ai >> shift) & 0xFF) == 0)  {  continue;  }      // all the states have the same byte (0)
+
+    for (unsigned int d=0; d<256; d++)  {  Count[d] = 0;  }
+    for (auto const& it : Kset_ICC)  {  Count[(it.first >> shift) & 0xFF]++;  }
+
+    unsigned int start = 0, c = 0;
+    for (unsigned int d=0; d<256; d++)  {  c = Count[d];  Count[d] = start;  start += c;  }
+    for (auto const& it : Kset_ICC)  {  Buffer[Count[(it.first >> shift) & 0xFF]++] = it;  }
+
+    Kset_ICC.swap(Buffer);
+  }
+}
+
+// *** Same value as LogE_ICC(Kset, Ai, N) and LogE_ICC_Sorted(Kset, Ai, N, Kset_ICC); the states of Kset don't need to be distinct;
+// *** Kset_ICC and Buffer are buffers (to avoid a new allocation at each call):
+double LogE_ICC_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC, vector<pair<uint32_t, unsigned int>> &Buffer)
+{
+  Profile_Count(PROF_ICC_EVALUATIONS);
+
+  uint32_t m = bitset<32>(Ai).count();
+  double Sum_lgamma = 0;
+  unsigned int K_ICC = 0;
+
+  if ( m < 32 && (1UL << m) <= Kset.size() )       // *** dense:
+  {
+    Kset_ICC.assign((1UL << m), make_pair(0, 0));
+    for (auto const& it : Kset)  {  Kset_ICC[Pack_Bits(it.first, Ai)].second += it.second;  }
+
+    for (auto const& it : Kset_ICC)
+      {  if (it.second != 0)  {  Sum_lgamma += lgamma(it.second + 0.5);  K_ICC++;  }  }
+  }
+  else                                              // *** sparse:
+  {
+    Kset_ICC.resize(Kset.size());
+    Buffer.resize(Kset.size());
+    for (unsigned int i=0; i<Kset.size(); i++)
+      {  Kset_ICC[i] = make_pair(Kset[i].first & Ai, Kset[i].second);  }    // projected states
+    Radix_Sort_States(Kset_ICC, Buffer, Ai);
+
+    for (unsigned int i=0; i<Kset_ICC.size(); )
+    {
+      unsigned int Ks = 0;
+      uint32_t s = Kset_ICC[i].first;
+      for ( ; i<Kset_ICC.size() && Kset_ICC[i].first == s; i++)  {  Ks += Kset_ICC[i].second;  }
+      Sum_lgamma += lgamma(Ks + 0.5);
+      K_ICC++;
+    }
+  }
+
+  return LogE_ICC_from_Counts(Sum_lgamma, K_ICC, m, N);
+}
+
+/******************************************************************************/
+/**************   LogE of ALL the ICCs of the r first elements   **************/
+/******************************************************************************/
+// LogE_table[Ai] = LogE_ICC(Kset, Ai, N) for all the parts Ai of the r first basis elements (1 <= Ai < 2^r), with two methods:
+// ***   - sparse (few distinct states, |Kset| << 2^r): the parts are visited as a tree, where each part Ai is obtained by adding
+// ***     a lower element to a part B; the states sorted and grouped by (s & B) are then only split in two by the new element
+// ***     (the order of the states is kept from the parent part, and no sort is needed): O(|Kset|) operations per part;
+// ***   - dense (|Kset| close to 2^r): the histogram of each part is obtained from the histogram (2^(m+1) values) of a part with one more element,
+// ***     by adding the counts of the two values of the removed element: O(2^m) operations per part, i.e. O(3^r) in total.
+// Both give the same values (to the last bit) as LogE_ICC.
+
+// *** Distinct states of Kset, restricted to the r first elements (Kset is not modified):
+vector<pair<uint32_t, unsigned int>> Kset_Restricted(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int r)
+{
+  uint32_t R = (r < 32) ? ((1UL << r) - 1) : 0xFFFFFFFF;
+  vector<pair<uint32_t, unsigned int>> Kset_r(Kset.size());
+  for (unsigned int i=0; i<Kset.size(); i++)  {  Kset_r[i] = make_pair(Kset[i].first & R, Kset[i].second);  }
+  sort(Kset_r.begin(), Kset_r.end());
+
+  unsigned int K = 0;
+  for (unsigned int i=0; i<Kset_r.size(); i++)
+  {
+    if (K > 0 && Kset_r[K-1].first == Kset_r[i].first)  {  Kset_r[K-1].second += Kset_r[i].second;  }
+    else  {  Kset_r[K] = Kset_r[i];  K++;  }
+  }
+  Kset_r.resize(K);
+
+  return Kset_r;
+}
+
+/******************************************************************************/
+// *** SPARSE: Order[d] = indices of the states of Kset_r sorted by (s & B), Block_end[d] = end of each group of equal (s & B),
+// *** for the part B at depth d of the tree; the children of B are the parts B + {c}, for all the elements c below the lowest element b of B.
+struct Sparse_Projection {
+    vector<pair<uint32_t, unsigned int>> Kset_r;
+    vector<vector<uint32_t>> Order, Block_end;
+    unsigned int N;
+};
+
+void Sparse_Subtree(Sparse_Projection &P, unsigned int d, uint32_t B, unsigned int b, vector<double> &LogE_table)
+{
+  const vector<uint32_t> &Order = P.Order[d], &Block_end = P.Block_end[d];
+  vector<uint32_t> &Order_c = P.Order[d+1], &Block_end_c = P.Block_end[d+1];
+  uint32_t m = bitset<32>(B).count() + 1;
+
+  for (int c = b-1; c >= 0; c--)
+  {
+    uint32_t Ai = B | (1UL << c);
+    double Sum_lgamma = 0;
+    Order_c.clear();  Block_end_c.clear();
+
+    // *** Split each group of (s & B) in two: the states with s_c = 0, then with s_c = 1:
+    unsigned int start = 0;
+    for (auto const& end : Block_end)
+    {
+      unsigned int Ks0 = 0, Ks1 = 0;
+      for (unsigned int i=start; i<end; i++)
+        {  if ((P.Kset_r[Order[i]].first & (1UL << c)) == 0)  {  Order_c.push_back(Order[i]);  Ks0 += P.Kset_r[Order[i]].second;  }  }
+      if (Ks0 > 0)  {  Block_end_c.push_back(Order_c.size());  Sum_lgamma += lgamma(Ks0 + 0.5);  }
+
+      for (unsigned int i=start; i<end; i++)
+        {  if ((P.Kset_r[Order[i]].first & (1UL << c)) != 0)  {  Order_c.push_back(Order[i]);  Ks1 += P.Kset_r[Order[i]].second;  }  }
+      if (Ks1 > 0)  {  Block_end_c.push_back(Order_c.size());  Sum_lgamma += lgamma(Ks1 + 0.5);  }
+
+      start = end;
+    }
+    LogE_table[Ai] = LogE_ICC_from_Counts(Sum_lgamma, Block_end_c.size(), m, P.N);
+    Profile_Count(PROF_ICC_EVALUATIONS);
+
+    // *** All the states are distinct on Ai: they stay distinct on all the parts Ai + (elements below c):
+    if (Block_end_c.size() == P.Kset_r.size())
+    {
+      for (uint32_t S = 1; S < (1UL << c); S++)
+        {  LogE_table[Ai | S] = LogE_ICC_from_Counts(Sum_lgamma, Block_end_c.size(), m + bitset<32>(S).count(), P.N);  }
+      continue;
+    }
+
+    if (c > 0)  {  Sparse_Subtree(P, d+1, Ai, c, LogE_table);  }
+  }
+}
+
+// *** Kset_r: distinct states of Kset restricted to the r first elements (see Kset_Restricted):
+vector<double> LogE_AllSubsets_Sparse_Restricted(const vector<pair<uint32_t, unsigned int>> &Kset_r, unsigned int N, unsigned int r)
+{
+  vector<double> LogE_table((1UL << r), 0);
+
+  Sparse_Projection P;
+  P.Kset_r = Kset_r;
+  P.N = N;
+  P.Order.assign(r+1, vector<uint32_t>());
+  P.Block_end.assign(r+1, vector<uint32_t>());
+  for (auto& Order : P.Order)  {  Order.reserve(P.Kset_r.size());  }
+  for (auto& Block_end : P.Block_end)  {  Block_end.reserve(P.Kset_r.size());  }
+
+  for (uint32_t i=0; i<P.Kset_r.size(); i++)  {  P.Order[0].push_back(i);  }    // B = {}: a single group
+  P.Block_end[0].push_back(P.Kset_r.size());
+
+  if (r > 0)  {  Sparse_Subtree(P, 0, 0, r, LogE_table);  }
+  return LogE_table;
+}
+
+vector<double> LogE_AllSubsets_Sparse(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n)
+{
+  return LogE_AllSubsets_Sparse_Restricted(Kset_Restricted(Kset, r), N, r);
+}
+
+/******************************************************************************/
+// *** DENSE: Marginal[d] = histogram of the part B at depth d (2^|B| values, bits of the states packed on |B| bits);
+// *** the parts are visited by removing the elements one by one: the children of B are the parts B - {c}, for all the elements c
+// *** below the last element l removed (all the elements below l are in B, so c is at the position c in the packed states).
+void Dense_Subtree(vector<vector<unsigned int>> &Marginal, unsigned int d, uint32_t B, unsigned int l, unsigned int N, vector<double> &LogE_table)
+{
+  const vector<unsigned int> &H = Marginal[d];
+  uint32_t m = bitset<32>(B).count();
+
+  double Sum_lgamma = 0;
+  unsigned int K_ICC = 0;
+  for (auto const& Ks : H)  {  if (Ks != 0)  {  Sum_lgamma += lgamma(Ks + 0.5);  K_ICC++;  }  }
+  LogE_table[B] = LogE_ICC_from_Counts(Sum_lgamma, K_ICC, m, N);
+  Profile_Count(PROF_ICC_EVALUATIONS);
+
+  vector<unsigned int> &H_c = Marginal[d+1];
+  for (int c = l-1; c >= 0; c--)
+  {
+    if ((B ^ (1UL << c)) == 0)  {  continue;  }       // empty part
+    H_c.resize(H.size() / 2);
+
+    uint32_t low = (1UL << c) - 1;
+    for (uint32_t i=0; i<H_c.size(); i++)
+    {
+      uint32_t i0 = ((i & ~low) << 1) | (i & low);    // packed state with s_c = 0
+      H_c[i] = H[i0] + H[i0 | (1UL << c)];
+    }
+    Dense_Subtree(Marginal, d+1, B ^ (1UL << c), c, N, LogE_table);
+  }
+}
+
+vector<double> LogE_AllSubsets_Dense(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n)
+{
+  vector<double> LogE_table((1UL << r), 0);
+  if (r == 0)  {  return LogE_table;  }
+
+  vector<vector<unsigned int>> Marginal(r+1);
+  Marginal[0].assign((1UL << r), 0);
+  for (auto const& it : Kset)  {  Marginal[0][it.first & ((1UL << r) - 1)] += it.second;  }
+
+  Dense_Subtree(Marginal, 0, (1UL << r) - 1, r, N, LogE_table);
+  return LogE_table;
+}
+
+/******************************************************************************/
+// *** Choice of the method: the sparse method visits the |Kset_r| distinct states for each of the 2^r parts,
+// *** and the dense method visits 3^r values in total (sum of the 2^m values of all the parts of m elements);
+// *** a state costs about 4 times more than a value in the dense method (measured), hence the factor 4:
+vector<double> LogE_AllSubsets_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n)
+{
+  vector<pair<uint32_t, unsigned int>> Kset_r = Kset_Restricted(Kset, r);
+
+  if ( 4. * Kset_r.size() * pow(2., r) < pow(3., r) )
+    {  return LogE_AllSubsets_Sparse_Restricted(Kset_r, N, r);  }
+  else
+    {  return LogE_AllSubsets_Dense(Kset_r, N, r);  }
+}
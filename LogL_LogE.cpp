@@ -6,6 +6,8 @@
 using namespace std;
 
 #include "data.h"
+#include "partition.h"
+#include "profiling.h"
 
 /******************************************************************************/
 /************************ Build Kset for a single ICC  ************************/
@@ -13,6 +15,7 @@ using namespace std;
 map<uint32_t, unsigned int> build_Kset_ICC(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai)
 {
     map<uint32_t, unsigned int> Kset_ICC;
+    Profile_Count(PROF_MAP_ALLOCATIONS);
 
     uint32_t s;        // state
     //unsigned int ks=0; // number of time state s appears in the dataset
@@ -54,6 +57,7 @@ double LogE_CM(vector<pair<uint32_t, unsigned int>> Kset, uint32_t m, unsigned i
 
 double LogE_ICC(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai, unsigned int N)
 {
+  Profile_Count(PROF_ICC_EVALUATIONS);
   map<uint32_t, unsigned int > Kset_ICC = build_Kset_ICC(Kset, Ai);  /// Question: make an exception for the CM? i.e. if Ai = 1111...11 ??
 
   uint32_t m = bitset<n>(Ai).count();
@@ -87,7 +91,7 @@ double LogE_ICC(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai, unsigned
 //   i.e., that each basis element only appears in a single part of the partition.
 //bool check_partition(map<uint32_t, uint32_t> Partition);
 
-double LogE_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N)
+double LogE_MCM(const vector<pair<uint32_t, unsigned int>> &Kset, const Partition_t &Partition, unsigned int N)
 {
   //if (!check_partition(Partition)) {cout << "Error, the argument is not a partition." << endl; return 0;  }
 
@@ -95,17 +99,65 @@ double LogE_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_
   //{
     double LogE = 0; 
     unsigned int rank = 0;
-    map<uint32_t, uint32_t>::iterator Part;
 
-    for (Part = Partition.begin(); Part != Partition.end(); Part++)
+    for (unsigned int k=0; k<Partition.size; k++)
     {
-      LogE += LogE_ICC(Kset, (*Part).second, N);
-      rank += bitset<n>((*Part).second).count();
+      LogE += LogE_ICC(Kset, Partition.Part[k], N);
+      rank += bitset<n>(Partition.Part[k]).count();
     }  
     return LogE - ((double) (N * (n-rank))) * log(2.);
   //}
 }
 
+double LogE_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N)
+{
+  return LogE_MCM(Kset, Partition_from_map(Partition), N);
+}
+
+
+/******************************************************************************/
+/*******  LogE of an ICC for a symmetric Dirichlet prior of parameter alpha  ****/
+/******************************************************************************/
+// Same as LogE_ICC, with a Dirichlet prior of parameter alpha on the 2^m states of the ICC
+// (alpha = 1/2 is the Jeffreys prior used in LogE_ICC; alpha = 1 is the uniform prior):
+//    LogE = sum_s [lgamma(K_s + alpha) - lgamma(alpha)] + lgamma(2^m alpha) - lgamma(N + 2^m alpha),
+// where the sum only runs over the observed states (the unobserved states have a contribution of 0).
+// this function doesn't account of the contribution to LogE due to the non-modeled spins (i.e. N*log(2) per spin)
+
+double LogE_ICC_alpha(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai, unsigned int N, double alpha)
+{
+  Profile_Count(PROF_ICC_EVALUATIONS);
+  map<uint32_t, unsigned int > Kset_ICC = build_Kset_ICC(Kset, Ai);
+
+  uint32_t m = bitset<n>(Ai).count();
+  double alpha_tot = alpha * (double) (1UL << m);   // sum of the parameters of the prior
+
+  double LogE = 0;
+  map<uint32_t, unsigned int >::iterator it;
+
+  for (it = Kset_ICC.begin(); it!=Kset_ICC.end(); ++it)
+    {  LogE += lgamma((it->second) + alpha);  }
+
+  return LogE - Kset_ICC.size() * lgamma(alpha) + lgamma(alpha_tot) - lgamma(N + alpha_tot);
+}
+
+double LogE_MCM_alpha(const vector<pair<uint32_t, unsigned int>> &Kset, const Partition_t &Partition, unsigned int N, double alpha)
+{
+  double LogE = 0; 
+  unsigned int rank = 0;
+
+  for (unsigned int k=0; k<Partition.size; k++)
+  {
+    LogE += LogE_ICC_alpha(Kset, Partition.Part[k], N, alpha);
+    rank += bitset<n>(Partition.Part[k]).count();
+  }  
+  return LogE - ((double) (N * (n-rank))) * log(2.);
+}
+
+double LogE_MCM_alpha(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N, double alpha)
+{
+  return LogE_MCM_alpha(Kset, Partition_from_map(Partition), N, alpha);
+}
 
 /***********************************************************************************************************************/
 /***********************************************************************************************************************/
@@ -140,6 +192,7 @@ double LogL_CM(vector<pair<uint32_t, unsigned int>> Kset, unsigned int N)
 
 double LogL_ICC(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai, unsigned int N)
 {
+  Profile_Count(PROF_ICC_EVALUATIONS);
   map<uint32_t, unsigned int > Kset_ICC = build_Kset_ICC(Kset, Ai);
 
   double LogL = 0;
@@ -164,7 +217,7 @@ double LogL_ICC(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai, unsigned
 /******************** Log-likelihood (LogL) of a MCM  *************************/
 /******************************************************************************/
 
-double LogL_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N)
+double LogL_MCM(const vector<pair<uint32_t, unsigned int>> &Kset, const Partition_t &Partition, unsigned int N)
 {
   //if (!check_partition(Partition)) {cout << "Error, the argument is not a partition." << endl; return 0;  }
 
@@ -172,14 +225,72 @@ double LogL_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_
   //{
     double LogL = 0; 
     unsigned int rank = 0;
-    map<uint32_t, uint32_t>::iterator Part;
 
-    for (Part = Partition.begin(); Part != Partition.end(); Part++)
+    for (unsigned int k=0; k<Partition.size; k++)
     {
-      LogL += LogL_ICC(Kset, (*Part).second, N);
-      rank += bitset<n>((*Part).second).count();
+      LogL += LogL_ICC(Kset, Partition.Part[k], N);
+      rank += bitset<n>(Partition.Part[k]).count();
     }  
     return LogL - ((double) (N * (n-rank))) * log(2.);
   //}
 }
 
+double LogL_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N)
+{
+  return LogL_MCM(Kset, Partition_from_map(Partition), N);
+}
+
+
+/******************************************************************************/
+/*************  Held-out Log-Likelihood of an ICC part of a MCM   *************/
+/******************************************************************************/
+// Log-likelihood of the test data (Kset_test) for the ICC defined by Ai, with parameters learned on the training data (Kset_train);
+// The probability of a state of the ICC is estimated with the Jeffreys prior (i.e. (K_train + 1/2) / (N_train + 2^(m-1))),
+// so that states of the test set that are not observed in the training set do not lead to an infinite LogL.
+// this function doesn't account of the contribution to LogL due to the non-modeled spins (i.e. N_test*log(2) per spin)
+
+double LogL_ICC_HeldOut(const vector<pair<uint32_t, unsigned int>> &Kset_train, unsigned int N_train, const vector<pair<uint32_t, unsigned int>> &Kset_test, uint32_t Ai)
+{
+  Profile_Count(PROF_ICC_EVALUATIONS);
+  map<uint32_t, unsigned int > Kset_ICC_train = build_Kset_ICC(Kset_train, Ai);
+  map<uint32_t, unsigned int > Kset_ICC_test = build_Kset_ICC(Kset_test, Ai);
+
+  uint32_t m = bitset<n>(Ai).count();
+  double Z = ((double) N_train) + (double) ( 1UL << (m-1) );  // normalisation of the estimated probabilities
+
+  double LogL = 0;
+  double K_train = 0;
+
+  map<uint32_t, unsigned int >::iterator it, it_train;
+
+  for (it = Kset_ICC_test.begin(); it!=Kset_ICC_test.end(); ++it)
+  {
+    it_train = Kset_ICC_train.find(it->first);
+    K_train = (it_train == Kset_ICC_train.end()) ? 0 : (it_train->second);
+    LogL += (it->second) * log((K_train + 0.5) / Z);
+  }
+
+  return LogL;
+}
+
+/******************************************************************************/
+/**************** Held-out Log-likelihood (LogL) of a MCM  ********************/
+/******************************************************************************/
+
+double LogL_MCM_HeldOut(const vector<pair<uint32_t, unsigned int>> &Kset_train, unsigned int N_train, const vector<pair<uint32_t, unsigned int>> &Kset_test, unsigned int N_test, const Partition_t &Partition)
+{
+  double LogL = 0; 
+  unsigned int rank = 0;
+
+  for (unsigned int k=0; k<Partition.size; k++)
+  {
+    LogL += LogL_ICC_HeldOut(Kset_train, N_train, Kset_test, Partition.Part[k]);
+    rank += bitset<n>(Partition.Part[k]).count();
+  }  
+  return LogL - ((double) (N_test * (n-rank))) * log(2.);
+}
+
+double LogL_MCM_HeldOut(const vector<pair<uint32_t, unsigned int>> &Kset_train, unsigned int N_train, const vector<pair<uint32_t, unsigned int>> &Kset_test, unsigned int N_test, map<uint32_t, uint32_t> Partition)
+{
+  return LogL_MCM_HeldOut(Kset_train, N_train, Kset_test, N_test, Partition_from_map(Partition));
+}
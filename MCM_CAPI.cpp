@@ -0,0 +1,192 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <climits>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+#include "data.h"
+#include "partition.h"
+#include "mcm_engine.h"
+#include "mcm_capi.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best);
+map<uint32_t, uint32_t> Convert_Partition_forMCM(uint32_t *a, unsigned int r);
+unsigned long long For_Each_Partition(unsigned int r, const function<void(const uint32_t *a, const Partition_t &Partition)> &Visit);
+vector<double> LogE_AllSubsets_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r);
+double LogE_ICC_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC, vector<pair<uint32_t, unsigned int>> &Buffer);
+
+map<uint32_t, uint32_t> MCM_Anytime(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, double *LogE_bound, double time_budget, const MCM_Search_Config &Config);
+map<uint32_t, uint32_t> MCM_GivenRank_r_Annealing(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, const MCM_Search_Config &Config, unsigned int n_steps, unsigned int n_restarts, unsigned int n_chains, unsigned int n_threads, unsigned int log2_cache_size, unsigned int seed);
+
+/******************************************************************************/
+/***********************   HISTOGRAM of the CALLER   **************************/
+/******************************************************************************/
+// *** Call f(state, count) for all the observed states of the histogram (the states with a count of 0 are skipped):
+template <class Function>
+void For_Each_State(const mcm_histogram &h, Function f)
+{
+  if (h.states != NULL)  {  for (size_t i=0; i<h.size; i++)  {  if (h.counts[i] != 0)  {  f(h.states[i], h.counts[i]);  }  }  }
+  else  {  for (size_t s=0; s<h.size; s++)  {  if (h.counts[s] != 0)  {  f((uint32_t) s, h.counts[s]);  }  }  }
+}
+
+// *** Check the histogram and compute the number N of datapoints:
+int Check_Histogram(const mcm_histogram *h, unsigned int *N)
+{
+  if (h == NULL || h->counts == NULL || h->size == 0 || h->n_spins == 0 || h->n_spins > 32)  {  return MCM_ERROR_ARGUMENT;  }
+  if (h->states == NULL && (h->n_spins > 31 || h->size != ((size_t) 1 << h->n_spins)))  {  return MCM_ERROR_ARGUMENT;  }
+
+  unsigned long long N_total = 0;
+  For_Each_State(*h, [&](uint32_t, uint32_t K)  {  N_total += K;  });
+  if (N_total == 0 || N_total > UINT_MAX)  {  return MCM_ERROR_ARGUMENT;  }
+
+  *N = (unsigned int) N_total;
+  return MCM_OK;
+}
+
+/******************************************************************************/
+/*********************   BEST MCM for a TABLE of LogE   ***********************/
+/******************************************************************************/
+// *** Compare all the MCMs of rank r (Algorithm H, see For_Each_Partition), with the LogE of each part read in LogE_table:
+map<uint32_t, uint32_t> MCM_Exhaustive_Table(const vector<double> &LogE_table, unsigned int r, double *LogE_best)
+{
+  vector<uint32_t> aBest(r, 0);
+  *LogE_best = -INFINITY;
+
+  For_Each_Partition(r, [&](const uint32_t *a, const Partition_t &Partition)
+  {
+    double LogE = 0;
+    for (unsigned int i=0; i<Partition.size; i++)  {  LogE += LogE_table[Partition.Part[i]];  }
+    if (LogE > (*LogE_best))  {  *LogE_best = LogE;  aBest.assign(a, a+r);  }
+  });
+
+  return Convert_Partition_forMCM(aBest.data(), r);
+}
+
+/******************************************************************************/
+/******************************   C INTERFACE   *******************************/
+/******************************************************************************/
+extern "C" {
+
+int mcm_histogram_sparse(mcm_histogram *h, const uint32_t *states, const uint32_t *counts, size_t size, unsigned int n_spins)
+{
+  if (h == NULL || states == NULL || counts == NULL)  {  return MCM_ERROR_ARGUMENT;  }
+  h->states = states;  h->counts = counts;  h->size = size;  h->n_spins = n_spins;
+  return MCM_OK;
+}
+
+int mcm_histogram_dense(mcm_histogram *h, const uint32_t *counts, unsigned int n_spins)
+{
+  if (h == NULL || counts == NULL || n_spins == 0 || n_spins > 31)  {  return MCM_ERROR_ARGUMENT;  }
+  h->states = NULL;  h->counts = counts;  h->size = ((size_t) 1 << n_spins);  h->n_spins = n_spins;
+  return MCM_OK;
+}
+
+int mcm_search(const mcm_histogram *h, unsigned int r, mcm_engine engine, double time_budget, uint32_t *parts, unsigned int parts_capacity, unsigned int *n_parts, double *LogE)
+{
+  unsigned int N = 0;
+  int code = Check_Histogram(h, &N);
+  if (code != MCM_OK)  {  return code;  }
+  if (parts == NULL || n_parts == NULL || LogE == NULL)  {  return MCM_ERROR_ARGUMENT;  }
+  if (r == 0 || r > h->n_spins)  {  return MCM_ERROR_RANK;  }
+  if (parts_capacity < r)  {  return MCM_ERROR_BUFFER;  }
+
+  try
+  {
+    map<uint32_t, uint32_t> Partition;
+    double LogE_best = 0;
+
+    if (engine == MCM_ENGINE_SUBSET_DP || engine == MCM_ENGINE_EXHAUSTIVE)
+    {
+      if (r > ((engine == MCM_ENGINE_SUBSET_DP) ? 24 : 20))  {  return MCM_ERROR_RANK;  }
+
+      // *** LogE of all the ICCs, from a single copy of the histogram restricted to the r first spins (see ICC_Projection.cpp):
+      uint32_t R = (1UL << r) - 1;
+      vector<pair<uint32_t, unsigned int>> Kset_r;
+      For_Each_State(*h, [&](uint32_t s, uint32_t K)  {  Kset_r.push_back(make_pair(s & R, K));  });
+      vector<double> LogE_table = LogE_AllSubsets_Projected(Kset_r, N, r);
+
+      if (engine == MCM_ENGINE_SUBSET_DP)  {  Partition = MCM_SubsetDP(LogE_table, r, &LogE_best);  }
+      else  {  Partition = MCM_Exhaustive_Table(LogE_table, r, &LogE_best);  }
+      LogE_best -= ((double) N) * (h->n_spins - r) * log(2.);     // contribution of the non-modeled spins
+    }
+    else if (engine == MCM_ENGINE_ANYTIME || engine == MCM_ENGINE_ANNEALING)
+    {
+      if (r > n || h->n_spins > 32)  {  return MCM_ERROR_RANK;  }
+
+      vector<pair<uint32_t, unsigned int>> Kset;
+      Kset.reserve(h->size);
+      For_Each_State(*h, [&](uint32_t s, uint32_t K)  {  Kset.push_back(make_pair(s, K));  });
+      sort(Kset.begin(), Kset.end());
+
+      // *** Nothing is printed, neither in the terminal nor in files:
+      MCM_Search_Config Config;
+      Config.r = r;  Config.out = NULL;  Config.print_files = false;  Config.progress_interval = 0;
+
+      double LogE_bound = 0;
+      if (engine == MCM_ENGINE_ANYTIME)  {  Partition = MCM_Anytime(Kset, N, &LogE_best, &LogE_bound, time_budget, Config);  }
+      else  {  Partition = MCM_GivenRank_r_Annealing(Kset, N, &LogE_best, Config, 100000, 10, 0, 0, 20, 1);  }
+      LogE_best += ((double) N) * ((double) n - (double) h->n_spins) * log(2.);   // the functions above count n (data.h) spins
+    }
+    else  {  return MCM_ERROR_ARGUMENT;  }
+
+    *n_parts = 0;
+    for (auto const& Part : Partition)  {  parts[(*n_parts)++] = Part.second;  }
+    *LogE = LogE_best;
+  }
+  catch (...)  {  return MCM_ERROR_INTERNAL;  }
+
+  return MCM_OK;
+}
+
+int mcm_logE(const mcm_histogram *h, const uint32_t *parts, unsigned int n_parts, double *LogE)
+{
+  unsigned int N = 0;
+  int code = Check_Histogram(h, &N);
+  if (code != MCM_OK)  {  return code;  }
+  if (parts == NULL || LogE == NULL)  {  return MCM_ERROR_ARGUMENT;  }
+
+  uint32_t all_spins = (h->n_spins == 32) ? 0xFFFFFFFF : ((1UL << h->n_spins) - 1);
+  uint32_t used = 0;
+  for (unsigned int k=0; k<n_parts; k++)
+  {
+    if (parts[k] == 0 || (parts[k] & used) != 0 || (parts[k] & ~all_spins) != 0)  {  return MCM_ERROR_ARGUMENT;  }   // not a partition
+    used |= parts[k];
+  }
+
+  try
+  {
+    // *** One copy of the histogram, projected on each part (see ICC_Projection.cpp):
+    vector<pair<uint32_t, unsigned int>> Kset, Kset_ICC, Buffer;
+    For_Each_State(*h, [&](uint32_t s, uint32_t K)  {  Kset.push_back(make_pair(s, K));  });
+
+    double LogE_MCM = 0;
+    for (unsigned int k=0; k<n_parts; k++)  {  LogE_MCM += LogE_ICC_Projected(Kset, parts[k], N, Kset_ICC, Buffer);  }
+    *LogE = LogE_MCM - ((double) N) * (h->n_spins - bitset<32>(used).count()) * log(2.);
+  }
+  catch (...)  {  return MCM_ERROR_INTERNAL;  }
+
+  return MCM_OK;
+}
+
+const char *mcm_error_string(int code)
+{
+  switch (code)
+  {
+    case MCM_OK:  return "ok";
+    case MCM_ERROR_ARGUMENT:  return "invalid argument (NULL pointer, empty histogram, or invalid partition)";
+    case MCM_ERROR_RANK:  return "invalid rank for this histogram or this engine";
+    case MCM_ERROR_BUFFER:  return "the buffer for the parts is too small (at least r elements are needed)";
+    case MCM_ERROR_INTERNAL:  return "internal error";
+    default:  return "unknown error code";
+  }
+}
+
+}
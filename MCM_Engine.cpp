@@ -0,0 +1,626 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "mcm_engine.h"
+#include "profiling.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+double LogE_ICC_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, uint32_t Ai, unsigned int N, vector<pair<uint32_t, unsigned int>> &Kset_ICC, vector<pair<uint32_t, unsigned int>> &Buffer);
+double Complexity_MCM(const Partition_t &Partition, unsigned int N, double *C_param, double *C_geom);
+
+map<uint32_t, uint32_t> Convert_Partition_forMCM(uint32_t *a, unsigned int r);
+Partition_t Convert_Partition_forMCM_compact(const uint32_t *a, unsigned int r);
+Partition_t Convert_Partition_forMCM_withSubPart_compact(const uint32_t *a, bool *keep_SubPartition, unsigned int r);
+int find_j(uint32_t *a, uint32_t *b, unsigned int r);
+
+double Bell_number(unsigned int r);
+Search_Progress Progress_Start(string name, double total, double interval, string filename);
+void Progress_Update(Search_Progress &P, unsigned long long counter, double LogE_best);
+void Progress_End(Search_Progress &P, unsigned long long counter, double LogE_best);
+
+/******************************************************************************/
+/***************************   CONSTRUCTOR   **********************************/
+/******************************************************************************/
+MCM_Search_Engine::MCM_Search_Engine(const vector<pair<uint32_t, unsigned int>> &Kset_, unsigned int N_, MCM_Search_Config Config_)
+  : Config(Config_), Kset(Kset_), N(N_),
+    Own_cache((Config_.cache != NULL) ? NULL : new Tiered_LogE_Cache(Config_.r, Config_.cache_memory)),
+    LogE_ICC_cache((Config_.cache != NULL) ? *Config_.cache : *Own_cache),
+    Null_stream(NULL), out((Config_.out != NULL) ? *Config_.out : Null_stream)
+{
+}
+
+/******************************************************************************/
+/*****************************   LogE   ***************************************/
+/******************************************************************************/
+// *** Same values as the free functions LogE_ICC and LogE_MCM (the parts are added in the same order):
+double MCM_Search_Engine::LogE_ICC(uint32_t Ai)
+{
+  double LogE = 0;
+  if (LogE_ICC_cache.Find(Ai, &LogE))  {  Profile_Count(PROF_CACHE_HITS);  return LogE;  }
+
+  LogE = LogE_ICC_Projected(Kset, Ai, N, Kset_ICC, Buffer);     // projection of Kset on Ai (see ICC_Projection.cpp)
+  LogE_ICC_cache.Insert(Ai, LogE);
+  return LogE;
+}
+
+double MCM_Search_Engine::LogE_MCM(const Partition_t &Partition)
+{
+  double LogE_Parts[32];
+  return LogE_MCM(Partition, LogE_Parts);
+}
+
+// *** Same, and LogE_Parts[k] = LogE of the part k:
+double MCM_Search_Engine::LogE_MCM(const Partition_t &Partition, double *LogE_Parts)
+{
+  double LogE = 0;
+  unsigned int rank = 0;
+
+  for (unsigned int k=0; k<Partition.size; k++)
+  {
+    LogE_Parts[k] = LogE_ICC(Partition.Part[k]);
+    LogE += LogE_Parts[k];
+    rank += bitset<n>(Partition.Part[k]).count();
+  }
+  return LogE - ((double) (N * (n-rank))) * log(2.);
+}
+
+// *** LogE of the sub-MCM obtained by removing the part k of an MCM (of evidence LogE_MCM, and parts of evidence LogE_Parts):
+// *** the m spins of the part are then not modeled, and contribute by -N*m*log(2) (no LogE_ICC to compute):
+double MCM_Search_Engine::LogE_SubMCM(double LogE_MCM, const Partition_t &Partition, const double *LogE_Parts, unsigned int k)
+{
+  return LogE_MCM - LogE_Parts[k] - ((double) N) * bitset<n>(Partition.Part[k]).count() * log(2.);
+}
+
+/******************************************************************************/
+// *** Version 1:
+// ***            Compare all the MCM of rank r = Config.r,
+// ***            based on the r first elements of the basis used to build Kset:
+/******************************************************************************/
+map<uint32_t, uint32_t> MCM_Search_Engine::GivenRank_r(double *LogE_best)
+{
+  Profile_Timer Timer("MCM_GivenRank_r", true);     // hot kernel: hardware counters if requested
+  const unsigned int r = Config.r;
+  const bool print_bool = Config.print_bool;
+  out << "--->> Search for the best MCM.." << endl << endl;
+
+  unsigned long long counter = 0;
+  int i = 0;
+  string xx_st = "";
+  for(int i=0; i<n-r; i++)
+    {  xx_st += "_";  }
+
+  // *** Print in file Best MCMs:
+  Output_File file_BestMCM;
+  if (Config.print_files)  {  file_BestMCM.open(Config.output_directory + "BestMCM_Rank_r=" + to_string(r) + ".dat");  }
+  file_BestMCM << "# 1:Partition \t 2:LogE " << endl;
+
+  // *** Print in file all MCMs:
+  Output_File file_MCM_Rank_r;
+  if (Config.print_files)  {  file_MCM_Rank_r.open(Config.output_directory + "AllMCMs_Rank_r" + to_string(r) + ".dat");  }
+  if(print_bool)
+  {
+    out << "--> Print the LogE-value of all the MCM of rank r=" << r << " in the file '";
+    out << (Config.output_directory + "AllMCMs_Rank_r=" + to_string(r) + ".dat") << "'" << endl << endl;
+    file_MCM_Rank_r << "# 1:Partition \t 2:LogE \t 3:C_K \t 4:C_geom \t 5:C_tot \t 6:counter" << endl;
+  }
+  else 
+  { 
+    file_MCM_Rank_r << "To activate the prints for all the MCMs of rank r="<< r << ","<< endl;
+    file_MCM_Rank_r << " specify `print_bool=true` in the last argument of the function MCM_GivenRank_r();"; 
+  }
+
+  // *** H1: Initialisation:
+  uint32_t *a = (uint32_t *)malloc(r*sizeof(uint32_t));
+  uint32_t *b = (uint32_t *)malloc(r*sizeof(uint32_t));
+  for (int i=0; i<r; i++)
+  {    a[i]=0; b[i]=1;  }
+  int j = r-1;
+
+  // *** LogE and Complexity
+  double LogE = 0;
+  double C_param = 0, C_geom = 0;
+  Partition_t Partition;
+
+  // *** Save Best MCMs:
+  uint32_t *aBest = (uint32_t *)malloc(n*sizeof(uint32_t));
+  for(int i=0; i<r; i++) {  aBest[i]=a[i];  }
+
+  *LogE_best = LogE_MCM(Convert_Partition_forMCM_compact(a, r));
+
+  // *** Progress report (number of MCMs of rank r = Bell number):
+  Search_Progress Progress = Progress_Start("MCM_GivenRank_r", Bell_number(r), Config.progress_interval, Config.progress_filename);
+
+  // *** ALGO H:
+  while(j != 0)
+  {
+    // *** H2: Visit:
+    counter++;  //file_MCM_Rank_r << counter << ": \t";
+    if ((counter & Progress_check_mask) == 0)  {  Progress_Update(Progress, counter, *LogE_best);  }
+    Partition = Convert_Partition_forMCM_compact(a, r);
+    LogE = LogE_MCM(Partition);     //LogE
+
+    // *** Print in file:
+    if(print_bool)
+    {
+      file_MCM_Rank_r << xx_st;
+      for (i=0; i<r; i++)   {    file_MCM_Rank_r << a[i];  }     //Print_Partition(a);
+
+      Complexity_MCM(Partition, N, &C_param, &C_geom);    //Complexity
+      file_MCM_Rank_r << " \t" << LogE << " \t" << C_param << " \t" << C_geom << " \t" << (C_param + C_geom) << " \t" << counter << endl;
+    }
+
+    // *** Best MCM LogE:
+    if ( LogE > (*LogE_best)) 
+    { 
+      *LogE_best = LogE;  //Best_MCM.clear(); Best_MCM.push_back(a);  
+      file_BestMCM << xx_st;
+      for (i=0; i<r; i++)   {    file_BestMCM << a[i];  aBest[i]=a[i];  } 
+      file_BestMCM << "\t " << LogE << " \t New \t " << counter << endl;  
+    }
+    else if ( LogE == (*LogE_best) )
+    {  
+      file_BestMCM << xx_st;
+      for (i=0; i<r; i++)   {    file_BestMCM << a[i];  aBest[i]=a[i];  }
+      file_BestMCM << "\t " << LogE << " \t Idem \t " << counter << endl;    
+    }
+
+    if(a[r-1] != b[r-1])  {  a[r-1] += 1;  }   // H3: increase a[r-1] up to reaching b[r-1]
+    else
+    {  
+      j = find_j(a,b,r);  //H4: find first index j (from the right) such that a[j] != b[j]
+      if (j==0) { break;  }   //H5: Increase a[j] unless j=0 [Terminate]
+      else 
+      {
+        a[j] += 1;
+        b[r-1] = b[j] + ((a[j]==b[j])?1:0);  // m
+        j++;      //H6: zero out a[j+1], ..., a[r-1]
+        while ( j < (r-1) )
+        {
+          a[j] = 0;
+          b[j] = b[r-1]; // = m
+          j++; 
+        }
+        a[r-1] = 0;
+      }
+    }
+  }
+
+  Progress_End(Progress, counter, *LogE_best);
+
+  file_BestMCM.close();
+  file_MCM_Rank_r.close();
+
+  out << "--> Number of MCModels (of rank r=" << r << ") that were compared: " << counter << endl;
+
+  out << endl << "********** Best MCM: **********";
+  out << endl << "\t !! The first operator of the basis provided corresponds to the bit the most on the right !!";
+  out << endl << "\t !! The last operator corresponds to the bit the most on the left !!" << endl << endl;;
+
+  out << "\t >> Best Model = ";
+  out << xx_st;
+  for(int i=0; i<r; i++) {  out << aBest[i];  }
+  out << "\t \t LogE = " << (*LogE_best) << endl << endl;
+
+  map<uint32_t, uint32_t> Partition_best = Convert_Partition_forMCM(aBest, r);
+  free(a); free(b); free(aBest);
+
+  return Partition_best;
+}
+
+/******************************************************************************/
+// *** Version 2:
+// ***            Compare all the MCM based on the k first elements of the basis used to build Kset,
+// ***            for all k=1 to r = Config.r:
+/******************************************************************************/
+map<uint32_t, uint32_t> MCM_Search_Engine::AllRank_SmallerThan_r_Ordered(double *LogE_best)
+{
+  Profile_Timer Timer("MCM_AllRank_SmallerThan_r_Ordered", true);     // hot kernel: hardware counters if requested
+  const unsigned int r = Config.r;
+  const bool print_bool = Config.print_bool;
+  unsigned long long counter = 0;
+  int i = 0;
+  unsigned long long counter_subMCM = 0;
+
+  string xx_st = "";
+  for(int i=0; i<n-r; i++)
+    {  xx_st += "_";  }
+
+  // *** Print in file Best MCMs:
+  Output_File file_BestMCM;
+  if (Config.print_files)  {  file_BestMCM.open(Config.output_directory + "BestMCM_Rank_r<=" + to_string(r) + "_Ordered.dat");  }
+  file_BestMCM << "# 1:Partition \t 2:LogE " << endl;
+
+  // *** Print in file all models:
+  Output_File file_allMCM_r;
+  if (Config.print_files)  {  file_allMCM_r.open(Config.output_directory +"AllMCMs_Rank_r=" + to_string(r) + ".dat");  }
+  Output_File file_allSubMCM;
+  if (Config.print_files)  {  file_allSubMCM.open(Config.output_directory +"AllMCMs_Rank_r<" + to_string(r) + "_Ordered.dat");  }
+
+  if(print_bool)
+  {
+    out << "--> Print the LogE-value of all the MCM of rank r=" << r << " in the file '";
+    out << (Config.output_directory +"AllMCMs_Rank_r=" + to_string(r) + ".dat") << "'" << endl << endl;
+
+    out << "--> Print the LogE-value of all the MCM of rank k<" << r << " in the file '";
+    out << (Config.output_directory +"AllMCMs_Rank_r<" + to_string(r) + "_Ordered.dat") << "'" << endl << endl;
+
+    file_allMCM_r << "# 1:Partition \t 2:LogE \t 3:C_K \t 4:C_geom \t 5:C_tot \t 6:counter" << endl;
+    file_allSubMCM << "# 1:Partition \t 2:LogE \t 3:C_K \t 4:C_geom \t 5:C_tot \t 6:counter" << endl;
+  }
+  else 
+  { 
+    file_allMCM_r << "To activate the prints for all the MCMs of rank r<="<< r << ","<< endl;
+    file_allMCM_r << " specify `print_bool=true` in the last argument of the function MCM_AllRank_SmallerThan_r_Ordered();"; 
+    file_allSubMCM << "To activate the prints for all the MCMs of rank r<="<< r << ","<< endl;
+    file_allSubMCM << " specify `print_bool=true` in the last argument of the function MCM_AllRank_SmallerThan_r_Ordered();"; 
+  }
+
+  // *** H1: Initialisation:
+  uint32_t *a = (uint32_t *)malloc(r*sizeof(uint32_t));
+  uint32_t *b = (uint32_t *)malloc(r*sizeof(uint32_t));
+  for (int i=0; i<r; i++)
+  {    a[i]=0; b[i]=1;  }
+  int j = r-1;
+
+  // *** LogE and Complexity
+  double LogE = 0, LogE_Parts[32];
+  double C_param = 0, C_geom = 0;
+  Partition_t Partition;
+
+  // *** Save Best MCMs:
+  uint32_t *aBest = (uint32_t *)malloc(r*sizeof(uint32_t));
+  for(int i=0; i<r; i++) {  aBest[i]=a[i];  }
+
+  *LogE_best = LogE_MCM(Convert_Partition_forMCM_compact(a, r));
+
+
+  // *** SubPartitions (rank < n):
+  bool keep_SubPartition = false;
+
+  // *** Progress report (number of MCMs of rank r = Bell number):
+  Search_Progress Progress = Progress_Start("MCM_AllRank_SmallerThan_r_Ordered", Bell_number(r), Config.progress_interval, Config.progress_filename);
+
+  // *** ALGO H:
+  while(j != 0)
+  {
+    // *** H2: Visit:
+    counter++;  //file_allMCM_r << counter << ": \t";
+    if ((counter & Progress_check_mask) == 0)  {  Progress_Update(Progress, counter, *LogE_best);  }
+
+    // *** Original Partition:
+    Partition = Convert_Partition_forMCM_withSubPart_compact(a, &keep_SubPartition, r);     //Print_Partition_Converted(Partition); 
+    LogE = LogE_MCM(Partition, LogE_Parts);     //LogE
+
+    // *** Print in file:
+    if(print_bool)
+    {
+      file_allMCM_r << xx_st;
+      for (i=0; i<r; i++)   {    file_allMCM_r << a[i];  }     //Print_Partition(a);
+
+      Complexity_MCM(Partition, N, &C_param, &C_geom);    //Complexity
+      file_allMCM_r << " \t" << LogE << " \t" << C_param << " \t" << C_geom << " \t" << (C_param + C_geom) << " \t" << counter << endl;
+    }
+
+    // *** Best MCM LogE:
+    if ( LogE > (*LogE_best)) 
+    { 
+      *LogE_best = LogE;  //Best_MCM.clear(); Best_MCM.push_back(a);  
+      file_BestMCM << xx_st;
+      for (i=0; i<r; i++)   {    file_BestMCM << a[i];     aBest[i]=a[i];  } 
+      file_BestMCM << "\t " << LogE << " \t New \t " << counter << endl;  
+    }
+    else if ( LogE == (*LogE_best) )
+    {  
+      file_BestMCM << xx_st;
+      for (i=0; i<r; i++)   {    file_BestMCM << a[i];     aBest[i]=a[i];  }
+      file_BestMCM << "\t " << LogE << " \t Idem \t " << counter << endl;    
+    }
+
+    // *** Sub-Partition:
+    if (keep_SubPartition)
+    {
+      counter_subMCM++;
+
+      LogE = LogE_SubMCM(LogE, Partition, LogE_Parts, 0);     //LogE, from the LogE of the parts of the partition
+      Partition_Erase(Partition, 0); //Print_Partition_Converted(Partition); 
+
+      // *** Print in file:
+      if(print_bool)
+      { 
+        file_allSubMCM << xx_st;
+        for (i=0; i<r; i++)     //Print_Partition(a);
+        {
+          if (a[i] == 0 )  {  file_allSubMCM << "x";  } 
+          else {  file_allSubMCM << (a[i]-1);  } 
+        }
+
+        Complexity_MCM(Partition, N, &C_param, &C_geom);    //Complexity
+        file_allSubMCM << " \t" << LogE << " \t" << C_param << " \t" << C_geom << " \t" << (C_param + C_geom) << " \t" << counter_subMCM << endl;
+      }
+
+      // *** Best MCM LogE:
+      if ( LogE > (*LogE_best) )
+      { 
+        *LogE_best = LogE;  //Best_MCM.clear(); Best_MCM.push_back(a); 
+        file_BestMCM << xx_st; 
+        for (i=0; i<r; i++)   
+          {    
+          if (a[i] != 0 )  {  file_BestMCM << (a[i]-1);    aBest[i] = (a[i]-1);  } 
+          else {  file_BestMCM << "x";   aBest[i] = -1;  } 
+          }
+        file_BestMCM << "\t " << LogE << " \t New" << endl;  
+      }
+      else if ( LogE == (*LogE_best) )
+      {  
+        file_BestMCM << xx_st;
+        for (i=0; i<r; i++)  
+        {
+          if (a[i] != 0 )  {  file_BestMCM << (a[i]-1);   aBest[i] = (a[i]-1);  } 
+          else {  file_BestMCM << "x";  aBest[i] = -1;  } 
+        }
+        file_BestMCM << "\t " << LogE << " \t Idem" << endl;    
+      }
+    }
+
+    if(a[r-1] != b[r-1])  {  a[r-1] += 1;  }   // H3: increase a[n-1] up to reaching b[n-1]
+    else
+    {  
+      j = find_j(a,b,r);  //H4: find first index j (from the right) such that a[j] != b[j]
+      if (j==0) { break;  }   //H5: Increase a[j] unless j=0 [Terminate]
+      else 
+      {
+        a[j] += 1;
+        b[r-1] = b[j] + ((a[j]==b[j])?1:0);  // m
+        j++;      //H6: zero out a[j+1], ..., a[n-1]
+        while ( j < (r-1) )
+        {
+          a[j] = 0;
+          b[j] = b[r-1]; // = m
+          j++; 
+        }
+        a[r-1] = 0;
+      }
+    }
+  }
+
+  Progress_End(Progress, counter, *LogE_best);
+
+  file_BestMCM.close();
+  file_allMCM_r.close();
+  file_allSubMCM.close();
+
+  out << "--> Number of MCM models (of rank <=" << r << ") that have been compared: " << counter + counter_subMCM << endl << endl;
+ 
+  out << endl << "********** Best MCM: **********";
+  out << endl << "\t !! The first operator of the basis provided corresponds to the bit the most on the right !!";
+  out << endl << "\t !! The last operator corresponds to the bit the most on the left !!" << endl << endl;;
+  
+  out << "\t >> Best Model = ";
+  out << xx_st;
+  for(int i=0; i<r; i++) {  if(aBest[i] != -1)  {out << aBest[i];}   else {out << "x";}   }
+  out << "\t \t LogE = " << (*LogE_best) << endl << endl;
+
+  map<uint32_t, uint32_t> Partition_best = Convert_Partition_forMCM(aBest, r);
+  free(a); free(b); free(aBest);
+
+  return Partition_best;
+}
+
+/******************************************************************************/
+// *** Version 3:
+// ***            Compare all the MCMs based on any subset of k elements of the r = Config.r first elements of the basis,
+// ***            for all k=1 to r:
+/******************************************************************************/
+map<uint32_t, uint32_t> MCM_Search_Engine::AllRank_SmallerThan_r_nonOrdered(double *LogE_best)
+{
+  Profile_Timer Timer("MCM_AllRank_SmallerThan_r_nonOrdered", true);     // hot kernel: hardware counters if requested
+  const unsigned int r = Config.r;
+  const bool print_bool = Config.print_bool;
+  out << "All MCM based on all subsets of r operators among n chosen independent operators, r<=n: " << endl;
+
+  unsigned long long counter = 0;
+  int i = 0;
+  unsigned long long counter_subMCM = 0;
+
+  string xx_st = "";
+  for(int i=0; i<n-r; i++)
+    {  xx_st += "_";  }
+
+  // *** Print in file Best MCMs:
+  Output_File file_BestMCM;
+  if (Config.print_files)  {  file_BestMCM.open(Config.output_directory + "BestMCM_Rank_r<=" + to_string(r) + "_NonOrdered.dat");  }
+  file_BestMCM << "# 1:Partition \t 2:LogE " << endl;
+
+  // *** Print in file:
+  Output_File file_allMCM_r;
+  if (Config.print_files)  {  file_allMCM_r.open(Config.output_directory +"AllMCMs_Rank_r=" + to_string(r) + ".dat");  }
+  Output_File file_allSubMCM;
+  if (Config.print_files)  {  file_allSubMCM.open(Config.output_directory +"AllMCMs_Rank_r<" + to_string(r) + "_NonOrdered.dat");  }
+
+  if(print_bool)
+  {
+    out << "--> Print the LogE-value of all the MCM of rank r=" << r << " in the file '";
+    out << (Config.output_directory +"AllMCMs_Rank_r=" + to_string(r) + ".dat") << "'" << endl << endl;
+
+    out << "--> Print the LogE-value of all the MCM of rank k<" << r << " in the file '";
+    out << (Config.output_directory +"AllMCMs_Rank_r<" + to_string(r) + "_Ordered.dat") << "'" << endl << endl;
+
+    file_allMCM_r << "# 1:Partition \t 2:LogE \t 3:C_K \t 4:C_geom \t 5:C_tot \t 6:counter" << endl;
+    file_allSubMCM << "# 1:Partition \t 2:LogE \t 3:C_K \t 4:C_geom \t 5:C_tot \t 6:counter" << endl;
+  }
+  else 
+  { 
+    file_allMCM_r << "To activate the prints for all the MCMs of rank r<="<< r << ","<< endl;
+    file_allMCM_r << " specify `print_bool=true` in the last argument of the function MCM_AllRank_SmallerThan_r_Ordered();"; 
+    file_allSubMCM << "To activate the prints for all the MCMs of rank r<="<< r << ","<< endl;
+    file_allSubMCM << " specify `print_bool=true` in the last argument of the function MCM_AllRank_SmallerThan_r_Ordered();"; 
+  }
+
+  // *** H1: Initialisation:
+  uint32_t *a = (uint32_t *)malloc(r*sizeof(uint32_t));
+  uint32_t *b = (uint32_t *)malloc(r*sizeof(uint32_t));
+  for (int i=0; i<r; i++)
+  {    a[i]=0; b[i]=1;  }
+  int j = r-1;
+
+  // *** LogE and Complexity
+  double LogE = 0, LogE_Partition = 0, LogE_Parts[32];
+  double C_param = 0, C_geom = 0;
+  Partition_t Partition, Partition_buffer;
+
+  //  *** Save Best MCMs:
+  uint32_t *aBest = (uint32_t *)malloc(r*sizeof(uint32_t));
+  for(int i=0; i<r; i++) {  aBest[i]=a[i];  }
+  *LogE_best = LogE_MCM(Convert_Partition_forMCM_compact(a, r));
+
+  // *** for SubModels:
+  uint32_t amax = 0, atest = 0;
+
+  //SubPartitions (rank < n):
+
+  // *** Progress report (number of MCMs of rank r = Bell number):
+  Search_Progress Progress = Progress_Start("MCM_AllRank_SmallerThan_r_nonOrdered", Bell_number(r), Config.progress_interval, Config.progress_filename);
+
+  //ALGO H:
+  while(j != 0) // && counter < 200)
+  {
+    // *** H2: Visit:   ******
+    counter++;
+    if ((counter & Progress_check_mask) == 0)  {  Progress_Update(Progress, counter, *LogE_best);  }
+
+    // *** Partition:
+    Partition = Convert_Partition_forMCM_compact(a, r); 
+    LogE = LogE_MCM(Partition, LogE_Parts);     //LogE
+    LogE_Partition = LogE;
+
+    // *** Print in file:
+    if(print_bool)
+    {
+      Complexity_MCM(Partition, N, &C_param, &C_geom);    //Complexity
+      file_allMCM_r << xx_st;
+      for (i=0; i<r; i++)   {    file_allMCM_r << a[i];  }
+      file_allMCM_r << " \t" << LogE << " \t" << C_param << " \t" << C_geom << " \t" << (C_param + C_geom) << " \t" << counter << endl;
+    }
+
+    // *** Best MCM LogE:
+    if ( LogE > (*LogE_best)) 
+    { 
+      *LogE_best = LogE; 
+      file_BestMCM << xx_st;
+      for (i=0; i<r; i++)   {    file_BestMCM << a[i];     aBest[i]=a[i];  } 
+      file_BestMCM << "\t " << LogE << " \t New" << endl;  
+    }
+    else if ( LogE == (*LogE_best)) 
+    {  
+      file_BestMCM << xx_st;
+      for (i=0; i<r; i++)   {    file_BestMCM << a[i];     aBest[i]=a[i];  }
+      file_BestMCM << "\t " << LogE << " \t Idem" << endl;    
+    }
+
+    // *** Find max value in a[]:  //amax=0;   for(i=0; i<n; i++)  {  if (a[i] > amax) { amax = a[i]; } }
+    if ( a[r-1] == b[r-1] ) { amax = b[r-1]; } else { amax = b[r-1]-1; } 
+
+    // *** Sub-Partition: ***************************** //
+    for(atest=0; atest<=amax; atest++)
+    {
+      counter_subMCM++;
+
+      // *** LogE, from the LogE of the parts of the partition:
+      LogE = LogE_SubMCM(LogE_Partition, Partition, LogE_Parts, atest);
+
+      // *** Print in file:
+      if(print_bool)
+      {
+        Partition_buffer = Partition;
+        Partition_Erase(Partition_buffer, atest);
+        Complexity_MCM(Partition_buffer, N, &C_param, &C_geom);    //Complexity
+
+        file_allSubMCM << xx_st;
+        for (i=0; i<r; i++) 
+        {
+          if (a[i] == atest )  {  file_allSubMCM << "x";  } 
+          else {  file_allSubMCM << a[i];  } 
+        }
+        file_allSubMCM << " \t" << LogE << " \t" << C_param << " \t" << C_geom << " \t" << (C_param + C_geom) << " \t" << counter_subMCM << endl;
+      }
+
+      // *** Best MCM LogE:
+      if ( LogE > (*LogE_best)) 
+      { 
+        *LogE_best = LogE;  //Best_MCM.clear(); Best_MCM.push_back(a);  
+
+        file_BestMCM << xx_st;
+        for (i=0; i<r; i++)   
+        {    
+          if (a[i] > atest )  {  file_BestMCM << (a[i]-1);    aBest[i] = (a[i]-1);  } 
+          else if (a[i] < atest )  {  file_BestMCM << a[i];    aBest[i] = a[i];  } 
+          else {  file_BestMCM << "x";   aBest[i] = -1;  } 
+        }
+        file_BestMCM << "\t " << LogE << " \t New" << endl;  
+      }
+      else if ( LogE == (*LogE_best)) 
+      {  
+        file_BestMCM << xx_st;
+        for (i=0; i<r; i++)  
+        {
+          if (a[i] > atest )  {  file_BestMCM << (a[i]-1);    aBest[i] = (a[i]-1);  } 
+          else if (a[i] < atest )  {  file_BestMCM << a[i];    aBest[i] = a[i];  } 
+          else {  file_BestMCM << "x";   aBest[i] = -1;  } 
+        }
+        file_BestMCM << "\t " << LogE << " \t Idem" << endl;    
+      }
+    }
+
+    if(a[r-1] != b[r-1])  {  a[r-1] += 1;  }   // H3: increase a[n-1] up to reaching b[n-1]
+    else
+    {  
+      j = find_j(a,b,r);  //H4: find first index j (from the right) such that a[j] != b[j]
+      if (j==0) { break;  }   //H5: Increase a[j] unless j=0 [Terminate]
+      else 
+      {
+        a[j] += 1;
+        b[r-1] = b[j] + ((a[j]==b[j])?1:0);  // m
+        j++;      //H6: zero out a[j+1], ..., a[n-1]
+        while ( j < (r-1) )
+        {
+          a[j] = 0;
+          b[j] = b[r-1]; // = m
+          j++; 
+        }
+        a[r-1] = 0;
+      }
+    }
+  }
+
+  Progress_End(Progress, counter, *LogE_best);
+
+  file_BestMCM.close();
+  file_allMCM_r.close();
+  file_allSubMCM.close();
+
+  out << "--> Number of MCM models (of rank <=" << r << ") that have been compared: " << counter + counter_subMCM << endl;
+ 
+  out << endl << "********** Best MCM: **********";
+  out << endl << "\t !! The first operator of the basis provided corresponds to the bit the most on the right !!";
+  out << endl << "\t !! The last operator corresponds to the bit the most on the left !!" << endl << endl;;
+  
+
+  out << "\t >> Best Model = ";
+  out << xx_st;
+  for(int i=0; i<n; i++) {  if(aBest[i] != -1)  {out << aBest[i];}   else {out << "x";}   }
+  out << "\t \t LogE = " << (*LogE_best) << endl << endl;
+
+  map<uint32_t, uint32_t> Partition_best = Convert_Partition_forMCM(aBest, r);
+  free(a); free(b); free(aBest);
+
+  return Partition_best;
+}
@@ -4,15 +4,17 @@
 #include <fstream>
 
 #include "data.h"
+#include "partition.h"
+#include "profiling.h"
 
 /******************************************************************************/
 /**************** Log-likelihood (LogL), Geometric Complexity *****************/
 /*************************  and Log-evidence (LogE) ***************************/
 /******************************************************************************/
 // Properties of MCM:
-double LogL_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N);
-double LogE_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N);
-double Complexity_MCM(map<uint32_t, uint32_t> Partition, unsigned int N, double *C_param, double *C_geom);
+double LogL_MCM(const vector<pair<uint32_t, unsigned int>> &Kset, const Partition_t &Partition, unsigned int N);
+double LogE_MCM(const vector<pair<uint32_t, unsigned int>> &Kset, const Partition_t &Partition, unsigned int N);
+double Complexity_MCM(const Partition_t &Partition, unsigned int N, double *C_param, double *C_geom);
 
 // Properties of SCM:
 double LogE_ICC(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai, unsigned int N);
@@ -29,23 +31,27 @@ double ParamComplexity_ICC(unsigned int m, unsigned int N);
 // i.e., that no basis element appears in more than 1 part of the partition.
 // i.e., that each basis element only appears in a single part of the partition.
 
-pair<bool, uint32_t> check_partition(map<uint32_t, uint32_t> Partition)
+pair<bool, uint32_t> check_partition(const Partition_t &Partition)
 {
-  map<uint32_t, uint32_t>::iterator Part;
   uint32_t sum = 0;
   uint32_t rank = 0; 
 
-  for (Part = Partition.begin(); Part != Partition.end(); Part++)
+  for (unsigned int k=0; k<Partition.size; k++)
   {
-    sum |= (*Part).second;
-    rank += bitset<n>((*Part).second).count();
-    //cout << bitset<n>( (*Part).second ) << " \t";
+    sum |= Partition.Part[k];
+    rank += bitset<n>(Partition.Part[k]).count();
+    //cout << bitset<n>( Partition.Part[k] ) << " \t";
   }
   //cout << bitset<n>(sum) << endl;
 
   return make_pair((bitset<n>(sum).count() == rank), rank);
 }
 
+pair<bool, uint32_t> check_partition(map<uint32_t, uint32_t> Partition)
+{
+  return check_partition(Partition_from_map(Partition));
+}
+
 /******************************************************************************/
 /***************************    Define an MCM   *******************************/
 /******************************************************************************/
@@ -91,15 +97,16 @@ map<uint32_t, uint32_t> Read_MCMParts_BinaryRepresentation(string MCM_binary_fil
 /********************************************************************/
 /*******    PRINT INFO on each PART of an MCM (= a partition)   *****/
 /********************************************************************/
-void PrintTerminal_MCM_Info(vector<pair<uint32_t, unsigned int>> Kset, unsigned int N, map<uint32_t, uint32_t> MCM_Partition)
+void PrintTerminal_MCM_Info(vector<pair<uint32_t, unsigned int>> Kset, unsigned int N, map<uint32_t, uint32_t> MCM_Partition_map)
 {
+  Partition_t MCM_Partition = Partition_from_map(MCM_Partition_map);
   uint32_t Part = 0, m=0;
   double C_param=0, C_geom=0;
   Complexity_MCM(MCM_Partition, N, &C_param, &C_geom);
   double LogL = LogL_MCM(Kset, MCM_Partition, N);
 
   cout << "********** General Information about the MCM: **********" << endl; 
-  cout << "The chosen MCM has " << MCM_Partition.size() << " partitions and the following properties:" << endl;
+  cout << "The chosen MCM has " << MCM_Partition.size << " partitions and the following properties:" << endl;
   cout << "\t LogL = " << LogL << endl;
   cout << " \t C_param = " << C_param << " \t \t C_geom = " << C_geom << endl;
   cout << " \t Total complexity = " << C_param + C_geom << endl;
@@ -112,9 +119,9 @@ void PrintTerminal_MCM_Info(vector<pair<uint32_t, unsigned int>> Kset, unsigned
   cout << endl << "\t !! The last operator corresponds to the leftmost bit !!" << endl << endl;;
   cout << "## 1:Part_int \t 2:Part_binary \t 3:LogL \t 4:C_param \t 5:C_geom \t 6:C_tot \t 7:LogE" << endl;
 
-  for (map<uint32_t, uint32_t>::iterator i = MCM_Partition.begin(); i != MCM_Partition.end(); i++)
+  for (unsigned int k=0; k<MCM_Partition.size; k++)
   {    
-    Part = (*i).second;
+    Part = MCM_Partition.Part[k];
     m = bitset<n>(Part).count();  // rank of the part (i.e. rank of the SCM)
     C_param = ParamComplexity_ICC(m, N);
     C_geom = GeomComplexity_ICC(m);
@@ -133,14 +140,15 @@ void PrintTerminal_MCM_Info(vector<pair<uint32_t, unsigned int>> Kset, unsigned
 /********************************************************************/
 void PrintInfo_All_Indep_Models(vector<pair<uint32_t, unsigned int>> Kset, unsigned int N)
 {
-  map<uint32_t, uint32_t> Partition_Indep;  uint32_t Op = 1;
+  Profile_Timer Timer("PrintInfo_All_Indep_Models");
+  Partition_t Partition_Indep;  uint32_t Op = 1;
   for (uint32_t i = 0 ; i<n; i++)
   {
-    Partition_Indep[i] = Op;
+    Partition_Add(Partition_Indep, Op);
     cout << "Add Op = " << Op << " \t LogE = " << LogE_MCM(Kset, Partition_Indep, N) << " \t LogL = " << LogL_MCM(Kset, Partition_Indep, N) << endl;    
     Op = Op << 1;
   }
-  Partition_Indep.clear();
+  Partition_Indep.size = 0;
 }
 
 /********************************************************************/
@@ -149,15 +157,16 @@ void PrintInfo_All_Indep_Models(vector<pair<uint32_t, unsigned int>> Kset, unsig
 /********************************************************************/
 void PrintInfo_All_SubComplete_Models(vector<pair<uint32_t, unsigned int>> Kset, unsigned int N)
 {
-  map<uint32_t, uint32_t> Partition_SC;  uint32_t Op = 1;
-  Partition_SC[0] = 0;
+  Profile_Timer Timer("PrintInfo_All_SubComplete_Models");
+  Partition_t Partition_SC;  uint32_t Op = 1;
+  Partition_Add(Partition_SC, 0);
   for (uint32_t i = 0 ; i<n; i++)
   {
-    Partition_SC[0] += Op;
+    Partition_SC.Part[0] += Op;
     cout << "Add Op = " << Op << " \t LogE = " << LogE_MCM(Kset, Partition_SC, N) << " \t LogL = " << LogL_MCM(Kset, Partition_SC, N) << endl;    
     Op = Op << 1;
   }
-  Partition_SC.clear();
+  Partition_SC.size = 0;
 }
 
 
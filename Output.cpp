@@ -0,0 +1,416 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <locale>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <fcntl.h>      /* open */
+#include <unistd.h>     /* write, close */
+
+using namespace std;
+
+#include "output.h"
+
+atomic<size_t> Output_buffer_size(1UL << 20);
+atomic<bool> Output_writer_thread(false);
+
+// *** Settings of the output files opened after this call (buffer size in bytes, and writer thread):
+void Set_Output(size_t buffer_size, bool writer_thread)
+{
+  Output_buffer_size = (buffer_size > 0) ? buffer_size : 1;
+  Output_writer_thread = writer_thread;
+}
+
+/******************************************************************************/
+/*********************   SHORTEST FORMAT of a DOUBLE   ************************/
+/******************************************************************************/
+// Digits of a double by the Grisu algorithm (F. Loitsch, "Printing floating-point numbers quickly and accurately with integers", 2010):
+// only integer operations on 64 bits, i.e. much faster than snprintf followed by a check with strtod.
+// The digits generated in the "safe" interval (Grisu2) always give back exactly the same double, but are not always the shortest ones;
+// as in Grisu3, the digits are also generated in the "unsafe" interval, which contains all the decimal numbers that give back the double:
+// if both have the same number of digits, the digits are the shortest ones; otherwise (rare), the shortest digits are found
+// with snprintf and strtod (see Shortest_Double).
+
+struct DiyFp {         // f * 2^e
+    uint64_t f;
+    int e;
+};
+
+DiyFp DiyFp_Mul(DiyFp x, DiyFp y)     // upper 64 bits of the product, rounded
+{
+  unsigned __int128 p = (unsigned __int128) x.f * y.f;
+  uint64_t h = (uint64_t) (p >> 64), l = (uint64_t) p;
+  return {h + (l >> 63), x.e + y.e + 64};
+}
+
+DiyFp DiyFp_Normalize(DiyFp x)
+{
+  int shift = __builtin_clzll(x.f);
+  return {x.f << shift, x.e - shift};
+}
+
+// *** Cached powers of ten: 10^k ~ f * 2^e (f normalized and rounded), for k = -300, -292, ..., 324;
+// *** computed once, exactly, with integers of many 32-bit words:
+const int Cached_Power_min_k = -300, Cached_Power_step = 8, N_Cached_Powers = 79;
+
+struct Cached_Power {
+    uint64_t f;
+    int e, k;
+};
+
+// *** Top 64 bits of the integer X (words in little-endian order), rounded; *shift = number of the bits below:
+uint64_t Top64_Bits(const vector<uint32_t> &X, int *shift)
+{
+  int top = X.size() - 1;
+  while (X[top] == 0)  {  top--;  }
+  int n_bits = 32 * top + (32 - __builtin_clz(X[top]));
+
+  auto bit = [&X](int i) -> uint64_t  {  return (i < 0) ? 0 : (X[i / 32] >> (i % 32)) & 1;  };
+  uint64_t f = 0;
+  for (int i = n_bits - 1; i >= n_bits - 64; i--)  {  f = (f << 1) | bit(i);  }
+  *shift = n_bits - 64;
+
+  if (bit(n_bits - 65))                                    // round half up
+    {  f++;  if (f == 0)  {  f = (1ULL << 63);  (*shift)++;  }  }
+  return f;
+}
+
+vector<Cached_Power> Compute_Cached_Powers()
+{
+  vector<Cached_Power> Powers(N_Cached_Powers);
+  for (int i=0; i<N_Cached_Powers; i++)
+  {
+    int k = Cached_Power_min_k + i * Cached_Power_step, shift = 0;
+    vector<uint32_t> X;
+
+    if (k >= 0)        // *** 10^k:
+    {
+      X.assign(36, 0);  X[0] = 1;
+      for (int j=0; j<k; j++)
+      {
+        uint64_t carry = 0;
+        for (auto& x : X)  {  uint64_t y = (uint64_t) x * 10 + carry;  x = (uint32_t) y;  carry = y >> 32;  }
+      }
+      Powers[i].f = Top64_Bits(X, &shift);
+      Powers[i].e = shift;
+    }
+    else               // *** floor(2^B / 10^|k|), with B large enough to keep more than 64 bits:
+    {
+      int B = 128 + 4 * (-k);
+      X.assign(B / 32 + 1, 0);  X[B / 32] = (1U << (B % 32));
+      for (int j=0; j<-k; j++)
+      {
+        uint64_t rem = 0;
+        for (int w = X.size()-1; w >= 0; w--)  {  uint64_t y = (rem << 32) | X[w];  X[w] = (uint32_t) (y / 10);  rem = y % 10;  }
+      }
+      Powers[i].f = Top64_Bits(X, &shift);
+      Powers[i].e = shift - B;
+    }
+    Powers[i].k = k;
+  }
+  return Powers;
+}
+
+// *** Digits of the number in the interval [W_minus, W_plus] with the fewest digits, closest to W if round_last;
+// *** v ~ digits * 10^(*K) (*K is the power of ten of the cached power on input); returns the number of digits:
+int Grisu_Generate(DiyFp W, DiyFp W_minus, DiyFp W_plus, bool round_last, char *digits, int *K)
+{
+  // *** Digit generation: integer part p1 and fractional part p2 of W_plus (in units of 2^e):
+  uint64_t delta = W_plus.f - W_minus.f, dist = W_plus.f - W.f;
+  int e = -W_plus.e;
+  uint64_t one = 1ULL << e;
+  uint32_t p1 = (uint32_t) (W_plus.f >> e);
+  uint64_t p2 = W_plus.f & (one - 1);
+
+  uint32_t pow10 = 1;
+  int n = 1;
+  while (n < 10 && p1 >= pow10 * 10ULL)  {  pow10 *= 10;  n++;  }
+
+  int len = 0;
+  uint64_t rest = 0, ten = 0;
+  bool done = false;
+  while (n > 0)
+  {
+    digits[len++] = '0' + p1 / pow10;
+    p1 %= pow10;
+    n--;
+    rest = ((uint64_t) p1 << e) + p2;
+    if (rest <= delta)  {  *K += n;  ten = (uint64_t) pow10 << e;  done = true;  break;  }
+    pow10 /= 10;
+  }
+  if (!done)
+  {
+    int m = 0;
+    do
+    {
+      p2 *= 10;  delta *= 10;  dist *= 10;
+      digits[len++] = '0' + (p2 >> e);
+      p2 &= one - 1;
+      m++;
+    } while (p2 > delta);
+    *K -= m;
+    rest = p2;  ten = one;
+  }
+
+  // *** Last digit closer to W:
+  if (round_last)
+  {
+    while (rest < dist && delta - rest >= ten && (rest + ten < dist || dist - rest > rest + ten - dist))
+      {  digits[len-1]--;  rest += ten;  }
+  }
+
+  return len;
+}
+
+// *** Digits of v > 0 (finite) in `digits`, with v ~ digits * 10^(*K); returns the number of digits;
+// *** *shortest = true if there are no shorter digits that give back v, otherwise *len_min = lower bound on their number:
+int Grisu_Digits(double v, char *digits, int *K, bool *shortest, int *len_min)
+{
+  static const vector<Cached_Power> Powers = Compute_Cached_Powers();
+
+  // *** v and its boundaries m- and m+ (half-way to the neighbouring doubles):
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  uint64_t E = bits >> 52, F = bits & ((1ULL << 52) - 1);
+  DiyFp w = (E == 0) ? DiyFp{F, 1 - 1075} : DiyFp{F + (1ULL << 52), (int) E - 1075};
+
+  DiyFp m_plus = DiyFp_Normalize({2 * w.f + 1, w.e - 1});
+  DiyFp m_minus = (F == 0 && E > 1) ? DiyFp{4 * w.f - 1, w.e - 2} : DiyFp{2 * w.f - 1, w.e - 1};
+  m_minus = {m_minus.f << (m_minus.e - m_plus.e), m_plus.e};
+  w = DiyFp_Normalize(w);
+
+  // *** Cached power c = 10^-k such that the exponent of w*c is in [-60, -32]:
+  int f = -60 - m_plus.e - 1;
+  int k = (f * 78913) / (1 << 18) + (f > 0);
+  const Cached_Power &c = Powers[(-Cached_Power_min_k + k + Cached_Power_step - 1) / Cached_Power_step];
+  DiyFp c_k = {c.f, c.e};
+
+  // *** The products are exact up to 1 unit of the last bit: the safe interval [W_minus+1, W_plus-1] only contains numbers
+  // *** that give back v, the unsafe interval [W_minus-1, W_plus+1] contains all of them:
+  DiyFp W = DiyFp_Mul(w, c_k), W_minus = DiyFp_Mul(m_minus, c_k), W_plus = DiyFp_Mul(m_plus, c_k);
+
+  char digits_unsafe[24];
+  int K_unsafe = -c.k;
+  *len_min = Grisu_Generate(W, {W_minus.f - 1, W_minus.e}, {W_plus.f + 1, W_plus.e}, false, digits_unsafe, &K_unsafe);
+
+  *K = -c.k;
+  int len = Grisu_Generate(W, {W_minus.f + 1, W_minus.e}, {W_plus.f - 1, W_plus.e}, true, digits, K);
+  *shortest = (len == *len_min);
+  return len;
+}
+
+// *** Shortest digits of x written as "%.<p>g" would write them (with p the number of digits), e.g. -3154.421234567 or 1.5e-05:
+void Shortest_Double(double x, char *s)    // s: at least 32 chars
+{
+  if (!std::isfinite(x))  {  snprintf(s, 32, "%g", x);  return;  }
+  if (std::signbit(x))  {  *s++ = '-';  x = -x;  }
+  if (x == 0)  {  strcpy(s, "0");  return;  }
+
+  char digits[24];
+  bool shortest = true;
+  int K = 0, len_min = 0, len = Grisu_Digits(x, digits, &K, &shortest, &len_min);
+
+  if (!shortest)                // *** shorter digits may exist (rare): the first precision that gives back x
+  {
+    for (int p = max(len_min, 1); p <= 17; p++)
+    {
+      snprintf(s, 31, "%.*g", p, x);
+      if (strtod(s, NULL) == x)  {  return;  }
+    }
+    return;
+  }
+
+  while (len > 1 && digits[len-1] == '0')  {  len--;  K++;  }
+  int X = len + K - 1;          // exponent of the first digit
+
+  if (X < -4 || X >= len)       // *** d.ddde+XX (at least two digits in the exponent, as printf)
+  {
+    *s++ = digits[0];
+    if (len > 1)  {  *s++ = '.';  memcpy(s, digits + 1, len - 1);  s += len - 1;  }
+    *s++ = 'e';
+    *s++ = (X < 0) ? '-' : '+';
+    int X_abs = abs(X);
+    if (X_abs >= 100)  {  *s++ = '0' + X_abs / 100;  }
+    *s++ = '0' + (X_abs / 10) % 10;
+    *s++ = '0' + X_abs % 10;
+    *s = '\0';
+  }
+  else if (X >= 0)              // *** ddd.ddd
+  {
+    memcpy(s, digits, X + 1);  s += X + 1;
+    if (len > X + 1)  {  *s++ = '.';  memcpy(s, digits + X + 1, len - X - 1);  s += len - X - 1;  }
+    *s = '\0';
+  }
+  else                          // *** 0.000ddd
+  {
+    *s++ = '0';  *s++ = '.';
+    for (int i = 0; i < -X-1; i++)  {  *s++ = '0';  }
+    memcpy(s, digits, len);  s[len] = '\0';
+  }
+}
+
+// *** Used by the Output_File for the doubles written with the default format (otherwise as any stream):
+class Roundtrip_num_put : public num_put<char> {
+  protected:
+    iter_type do_put(iter_type out, ios_base &str, char fill, double x) const
+    {
+      const ios_base::fmtflags special = ios_base::floatfield | ios_base::showpos | ios_base::showpoint | ios_base::uppercase;
+      if ((str.flags() & special) != 0 || str.precision() != 6 || str.width() != 0)
+        {  return num_put<char>::do_put(out, str, fill, x);  }
+
+      char s[32];
+      Shortest_Double(x, s);
+      for (const char *c = s; *c != '\0'; c++)  {  *out++ = *c;  }
+      return out;
+    }
+};
+
+const locale &Output_locale()
+{
+  static const locale Loc(locale::classic(), new Roundtrip_num_put);
+  return Loc;
+}
+
+/******************************************************************************/
+/**************************   OUTPUT BUFFER   *********************************/
+/******************************************************************************/
+// *** Write all the `size` bytes of `data` in the file (false if the file cannot be written):
+bool Write_All(int fd, const char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t k = write(fd, data, size);
+    if (k < 0 && errno == EINTR)  {  continue;  }
+    if (k <= 0)  {  return false;  }
+    data += k;  size -= k;
+  }
+  return true;
+}
+
+bool Output_Buffer::open(const string &filename, bool append, bool writer_thread)
+{
+  close();
+  fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+  if (fd < 0)  {  return false;  }
+
+  error = false;
+  bytes_written = 0;
+  Front.resize(Output_buffer_size.load());
+  setp(Front.data(), Front.data() + Front.size());
+
+  if (writer_thread)
+  {
+    Back.resize(Front.size());
+    Back_size = 0;
+    Writer_stop = false;
+    Writer = thread(&Output_Buffer::Writer_Loop, this);
+  }
+  return true;
+}
+
+// *** The text of the buffer Front is written in the file, or given to the writer thread (which then gives back an empty buffer):
+bool Output_Buffer::Write_Front()
+{
+  size_t size = pptr() - pbase();
+  if (size == 0)  {  return !error;  }
+  bytes_written += size;
+
+  if (!Writer.joinable())
+    {  if (!Write_All(fd, Front.data(), size))  {  error = true;  }  }
+  else
+  {
+    unique_lock<mutex> lock(Writer_mutex);
+    Writer_cv.wait(lock, [this]{  return Back_size == 0;  });     // the previous buffer is written
+    Front.swap(Back);
+    Back_size = size;
+    Writer_cv.notify_all();
+  }
+
+  setp(Front.data(), Front.data() + Front.size());
+  return !error;
+}
+
+void Output_Buffer::Writer_Loop()
+{
+  unique_lock<mutex> lock(Writer_mutex);
+  while (true)
+  {
+    Writer_cv.wait(lock, [this]{  return Back_size > 0 || Writer_stop;  });
+    if (Back_size == 0)  {  break;  }      // stop, and nothing left to write
+
+    size_t size = Back_size;
+    lock.unlock();
+    bool ok = Write_All(fd, Back.data(), size);
+    lock.lock();
+
+    if (!ok)  {  error = true;  }
+    Back_size = 0;
+    Writer_cv.notify_all();
+  }
+}
+
+int Output_Buffer::overflow(int c)
+{
+  if (fd < 0 || !Write_Front())  {  return traits_type::eof();  }
+  if (c != traits_type::eof())  {  *pptr() = c;  pbump(1);  }
+  return traits_type::not_eof(c);
+}
+
+streampos Output_Buffer::seekoff(streamoff off, ios_base::seekdir way, ios_base::openmode which)
+{
+  if (off != 0 || way != ios_base::cur || !(which & ios_base::out))  {  return streampos(-1);  }
+  return streampos(bytes_written + (pptr() - pbase()));
+}
+
+bool Output_Buffer::close()
+{
+  if (fd < 0)  {  return true;  }
+  Write_Front();
+
+  if (Writer.joinable())
+  {
+    {
+      lock_guard<mutex> lock(Writer_mutex);
+      Writer_stop = true;
+      Writer_cv.notify_all();
+    }
+    Writer.join();
+  }
+
+  if (::close(fd) != 0)  {  error = true;  }
+  fd = -1;
+  setp(NULL, NULL);
+  vector<char>().swap(Front);  vector<char>().swap(Back);
+  return !error;
+}
+
+/******************************************************************************/
+/***************************   OUTPUT FILE   **********************************/
+/******************************************************************************/
+Output_File::Output_File() : ostream(NULL)
+{
+  rdbuf(&Buffer);
+  imbue(Output_locale());
+}
+
+Output_File::Output_File(const string &filename, ios_base::openmode mode) : ostream(NULL)
+{
+  rdbuf(&Buffer);
+  imbue(Output_locale());
+  open(filename, mode);
+}
+
+void Output_File::open(const string &filename, ios_base::openmode mode)
+{
+  if (Buffer.open(filename, (mode & ios::app) != 0, Output_writer_thread))  {  clear();  }
+  else  {  setstate(ios::failbit);  }
+}
+
+void Output_File::close()
+{
+  if (!Buffer.close())  {  setstate(ios::failbit);  }
+}
@@ -2,12 +2,14 @@
 #include <cmath>       /* tgamma */
 #include <map>
 #include <list>
-#include <fstream>
 #include <vector>
 
 using namespace std;
 
 #include "data.h"
+#include "output.h"
+#include "partition.h"
+#include "profiling.h"
 
 
 /********************************************************************/
@@ -34,7 +36,7 @@ map<uint32_t, unsigned int > build_Kset_ICC(vector<pair<uint32_t, unsigned int>>
 //check if *Partition* is an actual partition of the basis elements, 
 // i.e., that no basis element appears in more than 1 part of the partition.
 // i.e., that each basis element only appears in a single part of the partition.
-pair<bool, uint32_t> check_partition(map<uint32_t, uint32_t> Partition);
+pair<bool, uint32_t> check_partition(const Partition_t &Partition);
 
 /******************************************************************************/
 /*****************   Compute the contribution to P_MCM(s)   *******************/
@@ -65,10 +67,11 @@ void update_proba_MCM(map<uint32_t, Proba> &all_P, map<uint32_t, unsigned int> K
 /******************************************************************************/
 // This function can be used directly on the original basis, by replacing Kset by Nset:
 
-map<uint32_t, Proba> P_sig(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N) // Probabilities in the sigma basis
+map<uint32_t, Proba> P_sig(const vector<pair<uint32_t, unsigned int>> &Kset, const Partition_t &Partition, unsigned int N) // Probabilities in the sigma basis
 {
   // Fill in the data probability:
   map<uint32_t, Proba> all_P;
+  Profile_Count(PROF_MAP_ALLOCATIONS);
   double Nd = (double) N;
 
   uint32_t s;        // state
@@ -96,12 +99,11 @@ map<uint32_t, Proba> P_sig(vector<pair<uint32_t, unsigned int>> Kset, map<uint32
 
     // Compute the Kset over each part: Kset_icc:
     map<uint32_t, unsigned int> Kset_icc;
-    map<uint32_t, uint32_t>::iterator Part;
 
-    for (Part = Partition.begin(); Part != Partition.end(); Part++)
+    for (unsigned int k=0; k<Partition.size; k++)
     {
-      Kset_icc = build_Kset_ICC(Kset, (*Part).second);         // (*Part).second) = Ai = integer indicated the spin elements included in b_a
-      update_proba_MCM(all_P, Kset_icc, (*Part).second, N);
+      Kset_icc = build_Kset_ICC(Kset, Partition.Part[k]);         // Partition.Part[k] = Ai = integer indicated the spin elements included in b_a
+      update_proba_MCM(all_P, Kset_icc, Partition.Part[k], N);
       Kset_icc.clear();
     }  
   }
@@ -109,16 +111,22 @@ map<uint32_t, Proba> P_sig(vector<pair<uint32_t, unsigned int>> Kset, map<uint32
   return all_P;
 }
 
+map<uint32_t, Proba> P_sig(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N)
+{
+  return P_sig(Kset, Partition_from_map(Partition), N);
+}
+
 
 void PrintFile_StateProbabilites_NewBasis(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> MCM_Partition, unsigned int N, string filename = "Result")
 {
+  Profile_Timer Timer("PrintFile_StateProbabilites_NewBasis");
   // Probabilities in the sigma basis:
-  map<uint32_t, Proba> P_all = P_sig(Kset, MCM_Partition, N);
+  map<uint32_t, Proba> P_all = P_sig(Kset, Partition_from_map(MCM_Partition), N);
   map<uint32_t, Proba>::iterator it_P;
 
   string Psig_filename = filename + "_DataVSMCM_Psig.dat";
 
-  fstream file_P_sig((OUTPUT_directory + Psig_filename), ios::out);
+  Output_File file_P_sig(OUTPUT_directory + Psig_filename);
   file_P_sig << "## 1:sig \t 2:P_D(sig) \t 3:P_MCM(sig)" << endl;
 
   for (it_P = P_all.begin(); it_P!=P_all.end(); ++it_P)
@@ -126,6 +134,7 @@ void PrintFile_StateProbabilites_NewBasis(vector<pair<uint32_t, unsigned int>> K
     file_P_sig << bitset<n>(it_P->first) << "\t " << (it_P->second).P_D_s << "\t " << (it_P->second).P_MCM << endl;
   }
 
+  Profile_Count(PROF_BYTES_WRITTEN, file_P_sig.tellp());
   file_P_sig.close();
 }
 
@@ -136,12 +145,13 @@ void PrintFile_StateProbabilites_NewBasis(vector<pair<uint32_t, unsigned int>> K
 /******************************************************************************/
 uint32_t transform_mu_basis(uint32_t mu, list<uint32_t> basis);
 
-map<uint32_t, Proba> P_s(vector<pair<uint32_t, unsigned int>> Nset, list<uint32_t> Basis, map<uint32_t, uint32_t> Partition, unsigned int N) // Probabilities in the sigma basis
+map<uint32_t, Proba> P_s(const vector<pair<uint32_t, unsigned int>> &Nset, list<uint32_t> Basis, const Partition_t &Partition, unsigned int N) // Probabilities in the sigma basis
 {
   double Nd = (double) N;
 
   // Fill in the data probability:
   map<uint32_t, Proba> all_P;
+  Profile_Count(PROF_MAP_ALLOCATIONS);
 
   if (!check_partition(Partition).first) {cout << "Error, the argument is not a partition: the function returned an empty map for P[s]." << endl; }
   else
@@ -196,14 +206,22 @@ map<uint32_t, Proba> P_s(vector<pair<uint32_t, unsigned int>> Nset, list<uint32_
   return all_P;  
 }
 
+map<uint32_t, Proba> P_s(vector<pair<uint32_t, unsigned int>> Nset, list<uint32_t> Basis, map<uint32_t, uint32_t> Partition, unsigned int N)
+{
+  return P_s(Nset, Basis, Partition_from_map(Partition), N);
+}
+
 /******************************************************************************/
 /*****************      PRINT FILE: INFO about an MCM     *********************/
 /******************************************************************************/
 
-void PrintFile_MCM_Info(list<uint32_t> Basis, map<uint32_t, uint32_t> MCM_Partition, string filename = "Result")
+void PrintFile_MCM_Info(list<uint32_t> Basis, map<uint32_t, uint32_t> MCM_Partition_map, string filename = "Result")
 {
+  Profile_Timer Timer("PrintFile_MCM_Info");
+  Partition_t MCM_Partition = Partition_from_map(MCM_Partition_map);
+
   //***** PRINT BASIS: 
-  fstream file_MCM_info((OUTPUT_directory + filename + "_MCM_info.dat"), ios::out);
+  Output_File file_MCM_info(OUTPUT_directory + filename + "_MCM_info.dat");
 
   file_MCM_info << "## sig_vec = states in the chosen new basis (ideally the best basis), defined by the basis operators:" << endl;
   int i = 1;
@@ -217,13 +235,14 @@ void PrintFile_MCM_Info(list<uint32_t> Basis, map<uint32_t, uint32_t> MCM_Partit
 
   //***** PRINT MCM: 
   i = 1;
-  for (map<uint32_t, uint32_t>::iterator it = MCM_Partition.begin(); it != MCM_Partition.end(); it++)
+  for (unsigned int k=0; k<MCM_Partition.size; k++)
   {    
-    uint32_t Part = (*it).second;
+    uint32_t Part = MCM_Partition.Part[k];
     file_MCM_info << "##\t MCM_Part_" << i << " = " << bitset<n>(Part) << " = " << Part << endl; i++;
   }
   file_MCM_info << "##" << endl;
 
+  Profile_Count(PROF_BYTES_WRITTEN, file_MCM_info.tellp());
   file_MCM_info.close();
 }
 
@@ -269,8 +288,9 @@ void PrintFile_MCM_Info(map<uint32_t, unsigned int > Kset, unsigned int N, map<u
 /******************************************************************************/
 void PrintFile_StateProbabilites_OriginalBasis(vector<pair<uint32_t, unsigned int>> Nset, list<uint32_t> Basis, map<uint32_t, uint32_t> MCM_Partition, unsigned int N, string filename = "Result")
 {
+  Profile_Timer Timer("PrintFile_StateProbabilites_OriginalBasis");
   // Compute all the state probabilities:
-  map<uint32_t, Proba> P_all = P_s(Nset, Basis, MCM_Partition, N);
+  map<uint32_t, Proba> P_all = P_s(Nset, Basis, Partition_from_map(MCM_Partition), N);
 
   double *Pk_D = (double *)malloc((n+1)*sizeof(double)); 
   double *Pk_MCM = (double *)malloc((n+1)*sizeof(double)); 
@@ -294,7 +314,7 @@ void PrintFile_StateProbabilites_OriginalBasis(vector<pair<uint32_t, unsigned in
 
   //***** Print P(s):  *****************************************************/
   uint32_t s;
-  fstream file_Ps((OUTPUT_directory + Ps_filename), ios::out);
+  Output_File file_Ps(OUTPUT_directory + Ps_filename);
 
   file_Ps << "## s = states in the original basis" << endl;
   file_Ps << "## sig = states in the chosen new basis (ideally the best basis)" << endl;
@@ -313,10 +333,11 @@ void PrintFile_StateProbabilites_OriginalBasis(vector<pair<uint32_t, unsigned in
     Pk_D[k] += (it_P->second).P_D_s;      // P[k] in the data
     Pk_MCM[k] += (it_P->second).P_MCM;    // P[k] from the MCM
   }
+  Profile_Count(PROF_BYTES_WRITTEN, file_Ps.tellp());
   file_Ps.close();
 
   //***** Print P(k):   ***************************************************/
-  fstream file_Pk((OUTPUT_directory + Pk_filename), ios::out);
+  Output_File file_Pk(OUTPUT_directory + Pk_filename);
 
   file_Pk << "## 1:k \t 2:P_D(k) \t 3:P_MCM(k)" << endl;
 
@@ -324,6 +345,7 @@ void PrintFile_StateProbabilites_OriginalBasis(vector<pair<uint32_t, unsigned in
   {
     file_Pk << k << "\t" << Pk_D[k] << "\t" << Pk_MCM[k] << endl;
   }
+  Profile_Count(PROF_BYTES_WRITTEN, file_Pk.tellp());
   file_Pk.close();
 }
 
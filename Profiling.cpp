@@ -0,0 +1,187 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>     /* getenv, atexit */
+#include <cstring>     /* memset */
+#include <map>
+#include <vector>
+#include <mutex>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+using namespace std;
+
+#include "data.h"
+#include "profiling.h"
+
+/******************************************************************************/
+/*************************   TIME of EACH PHASE   *****************************/
+/******************************************************************************/
+struct Profile_Phase {
+    unsigned long long calls = 0;
+    double seconds = 0;
+    bool HW = false;
+    long long HW_values[3] = {0, 0, 0};     // cycles, instructions, cache misses
+};
+
+// Rem: defined before the settings, so that they are destroyed after the report is written at exit (see atexit):
+vector<pair<string, Profile_Phase>> Profile_Phases;     // in the order of their first call
+mutex Profile_mutex;
+
+/******************************************************************************/
+/***************************   SETTINGS   *************************************/
+/******************************************************************************/
+// *** The profiling can be turned on without recompiling, with the environment variable MCM_PROFILE:
+// ***     MCM_PROFILE=1    --> timers and counters;
+// ***     MCM_PROFILE=hw   --> timers and counters, and hardware counters in the hot kernels (Linux only).
+bool Profiling_HW = false;
+string Profiling_filename = OUTPUT_directory + "Profile.json";
+
+void Profile_Write_Report_atexit();
+
+void Profile_Register_Report()
+{
+  static bool registered = false;
+  if (!registered)  {  atexit(Profile_Write_Report_atexit);  registered = true;  }
+}
+
+bool Profiling_from_environment()
+{
+  const char *env = getenv("MCM_PROFILE");
+  if (env == NULL || string(env) == "" || string(env) == "0")  {  return false;  }
+  Profiling_HW = (string(env) == "hw");
+  Profile_Register_Report();
+  return true;
+}
+
+bool Profiling_enabled = Profiling_from_environment();
+atomic<unsigned long long> Profile_Counters[PROF_N_COUNTERS];
+
+// *** Turn on (or off) the profiling; the report is written in the file `filename` at the end of the program:
+void Set_Profiling(bool enabled, bool hardware_counters = false, string filename = OUTPUT_directory + "Profile.json")
+{
+  if (enabled)  {  Profile_Register_Report();  }
+  Profiling_enabled = enabled;
+  Profiling_HW = hardware_counters;
+  Profiling_filename = filename;
+}
+
+/******************************************************************************/
+// *** Called at the end of the scope of each Profile_Timer:
+void Profile_Add_Time(const char *phase, double seconds, const long long *HW_values)
+{
+  lock_guard<mutex> lock(Profile_mutex);
+
+  unsigned int k = 0;
+  while (k < Profile_Phases.size() && Profile_Phases[k].first != phase)  {  k++;  }
+  if (k == Profile_Phases.size())  {  Profile_Phases.push_back(make_pair(string(phase), Profile_Phase()));  }
+
+  Profile_Phase &P = Profile_Phases[k].second;
+  P.calls++;
+  P.seconds += seconds;
+  if (HW_values != NULL)
+  {
+    P.HW = true;
+    for (unsigned int i=0; i<3; i++)  {  P.HW_values[i] += HW_values[i];  }
+  }
+}
+
+/******************************************************************************/
+/************************   HARDWARE COUNTERS   *******************************/
+/******************************************************************************/
+// *** Group of 3 counters of the calling thread (user space only), opened with perf_event_open;
+// *** if they cannot be opened (non-Linux system, or access restricted by /proc/sys/kernel/perf_event_paranoid), they are not used.
+atomic<bool> Profiling_HW_opened(false);    // true if the counters could be opened at least once
+
+#ifdef __linux__
+int Perf_Open(uint32_t type, uint64_t config, int group_fd)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = (group_fd == -1) ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+// *** HW_fd[3]: files of the 3 counters (the first one is the leader of the group); returns false if the counters are not used:
+bool Profile_HW_Start(int *HW_fd)
+{
+  HW_fd[0] = HW_fd[1] = HW_fd[2] = -1;
+#ifdef __linux__
+  if (!Profiling_HW)  {  return false;  }
+
+  HW_fd[0] = Perf_Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (HW_fd[0] >= 0)  {  HW_fd[1] = Perf_Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, HW_fd[0]);  }
+  if (HW_fd[1] >= 0)  {  HW_fd[2] = Perf_Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, HW_fd[0]);  }
+  if (HW_fd[2] < 0)      // *** one of the counters cannot be opened: the others are closed
+  {
+    for (unsigned int i=0; i<3; i++)  {  if (HW_fd[i] >= 0)  {  close(HW_fd[i]);  HW_fd[i] = -1;  }  }
+    return false;
+  }
+
+  Profiling_HW_opened = true;
+  ioctl(HW_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(HW_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+#else
+  return false;
+#endif
+}
+
+// *** Reads the group of counters, and closes the 3 files (closing the leader does not close the 2 others):
+void Profile_HW_Stop(int *HW_fd, long long *HW_values)
+{
+#ifdef __linux__
+  ioctl(HW_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  uint64_t buffer[4] = {0, 0, 0, 0};     // number of counters, then their values
+  if (read(HW_fd[0], buffer, sizeof(buffer)) > 0 && buffer[0] == 3)
+    {  for (unsigned int i=0; i<3; i++)  {  HW_values[i] = buffer[i+1];  }  }
+  for (int i=2; i>=0; i--)  {  close(HW_fd[i]);  HW_fd[i] = -1;  }
+#endif
+}
+
+/******************************************************************************/
+/*****************************   REPORT   *************************************/
+/******************************************************************************/
+void Profile_Write_Report(string filename)
+{
+  const char *Counter_names[PROF_N_COUNTERS] = {"ICC_evaluations", "cache_hits", "map_allocations", "bytes_written"};
+
+  lock_guard<mutex> lock(Profile_mutex);
+  fstream file(filename.c_str(), ios::out);
+  file.precision(10);
+
+  file << "{" << endl;
+  file << "  \"phases\": [" << endl;
+  for (unsigned int k=0; k<Profile_Phases.size(); k++)
+  {
+    const Profile_Phase &P = Profile_Phases[k].second;
+    file << "    {\"name\": \"" << Profile_Phases[k].first << "\", \"calls\": " << P.calls << ", \"time_s\": " << P.seconds;
+    if (P.HW)  {  file << ", \"cycles\": " << P.HW_values[0] << ", \"instructions\": " << P.HW_values[1] << ", \"cache_misses\": " << P.HW_values[2];  }
+    file << "}" << ((k+1 < Profile_Phases.size()) ? "," : "") << endl;
+  }
+  file << "  ]," << endl;
+
+  file << "  \"counters\": {";
+  for (unsigned int i=0; i<PROF_N_COUNTERS; i++)
+    {  file << ((i>0) ? ", " : "") << "\"" << Counter_names[i] << "\": " << Profile_Counters[i].load();  }
+  file << "}," << endl;
+  file << "  \"hardware_counters\": \"" << (!Profiling_HW ? "off" : (Profiling_HW_opened ? "on" : "unavailable")) << "\"" << endl;
+  file << "}" << endl;
+  file.close();
+}
+
+void Profile_Write_Report_atexit()
+{
+  if (Profiling_enabled)  {  Profile_Write_Report(Profiling_filename);  }
+}
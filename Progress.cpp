@@ -0,0 +1,144 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>      /* rename */
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+#include "data.h"
+#include "progress.h"
+
+/******************************************************************************/
+/***************************   BELL NUMBERS   *********************************/
+/******************************************************************************/
+// *** Number of partitions of a set of r elements (i.e. number of MCMs of rank r), computed with the Bell triangle;
+// *** in double, to avoid overflows for large r:
+double Bell_number(unsigned int r)
+{
+  vector<double> row(1, 1.);
+  for (unsigned int i=1; i<=r; i++)
+  {
+    vector<double> next(1, row.back());
+    for (auto const& x : row)  {  next.push_back(next.back() + x);  }
+    row = next;
+  }
+  return row[0];
+}
+
+/******************************************************************************/
+/***************************   SETTINGS   *************************************/
+/******************************************************************************/
+// *** By default, the progress of the searches is printed in the standard error every 10 seconds:
+double Progress_interval = 10;          // seconds between two reports (<= 0: no report)
+string Progress_filename = "";          // if not empty, the reports are written in this file instead of the standard error
+mutex Progress_settings_mutex;          // protects the two settings above
+
+void Set_Progress_Report(double interval, string status_filename = "")
+{
+  lock_guard<mutex> lock(Progress_settings_mutex);
+  Progress_interval = interval;
+  Progress_filename = status_filename;
+}
+
+double Progress_Default_Interval()
+{
+  lock_guard<mutex> lock(Progress_settings_mutex);
+  return Progress_interval;
+}
+
+string Progress_Default_Filename()
+{
+  lock_guard<mutex> lock(Progress_settings_mutex);
+  return Progress_filename;
+}
+
+/******************************************************************************/
+/*****************************   REPORTS   ************************************/
+/******************************************************************************/
+string Duration_to_String(double seconds)
+{
+  if (seconds != seconds || seconds > 1e9)  {  return "?";  }
+  unsigned long long s = (unsigned long long) seconds;
+  stringstream ss;
+  if (s >= 86400)  {  ss << s / 86400 << "d ";  }
+  if (s >= 3600)  {  ss << (s % 86400) / 3600 << "h ";  }
+  if (s >= 60)  {  ss << (s % 3600) / 60 << "min ";  }
+  ss << s % 60 << "s";
+  return ss.str();
+}
+
+// *** The status file is re-written at each report (through a temporary file, so that it is never read half-written):
+void Progress_Print(const Search_Progress &P, unsigned long long counter, double LogE_best, bool done)
+{
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - P.start).count();
+  double rate = (elapsed > 0) ? counter / elapsed : 0;
+  double percent = (P.total > 0) ? 100. * counter / P.total : 0;
+  double ETA = (done) ? 0 : ((rate > 0) ? (P.total - counter) / rate : NAN);
+
+  if (P.filename == "")
+  {
+    cerr << "[" << P.name << "] " << counter << " / " << P.total << " MCMs (" << percent << "%), \t " << rate << " MCMs/s, \t best LogE = " << LogE_best;
+    cerr << ", \t elapsed " << Duration_to_String(elapsed) << ((done) ? ", \t done" : ", \t ETA " + Duration_to_String(ETA)) << endl;
+  }
+  else
+  {
+    string tmp_filename = P.filename + ".tmp";
+    fstream file(tmp_filename.c_str(), ios::out);
+    file << "search = " << P.name << endl;
+    file << "status = " << ((done) ? "done" : "running") << endl;
+    file << "counter = " << counter << endl;
+    file << "total = " << P.total << endl;
+    file << "percent = " << percent << endl;
+    file << "rate = " << rate << endl;
+    file << "LogE_best = " << LogE_best << endl;
+    file << "elapsed_s = " << elapsed << endl;
+    file << "ETA_s = " << ETA << endl;
+    file.close();
+    rename(tmp_filename.c_str(), P.filename.c_str());
+  }
+}
+
+// *** Start the report for a search visiting `total` MCMs, with its own settings (e.g. of a MCM_Search_Engine):
+Search_Progress Progress_Start(string name, double total, double interval, string filename)
+{
+  Search_Progress P;
+  P.name = name;
+  P.total = total;
+  P.start = chrono::steady_clock::now();
+  P.last = P.start;
+  P.interval = interval;
+  P.filename = filename;
+  P.active = (interval > 0);
+  return P;
+}
+
+// *** Same, with the settings of Set_Progress_Report:
+Search_Progress Progress_Start(string name, double total)
+{
+  lock_guard<mutex> lock(Progress_settings_mutex);
+  return Progress_Start(name, total, Progress_interval, Progress_filename);
+}
+
+// *** To call every (Progress_check_mask + 1) MCMs:
+void Progress_Update(Search_Progress &P, unsigned long long counter, double LogE_best)
+{
+  if (!P.active)  {  return;  }
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  if (chrono::duration<double>(now - P.last).count() < P.interval)  {  return;  }
+
+  P.last = now;
+  P.n_reports++;
+  Progress_Print(P, counter, LogE_best, false);
+}
+
+// *** End of the search (reported only if the search was reported at least once, or in the status file):
+void Progress_End(Search_Progress &P, unsigned long long counter, double LogE_best)
+{
+  if (!P.active)  {  return;  }
+  if (P.n_reports > 0 || P.filename != "")  {  Progress_Print(P, counter, LogE_best, true);  }
+  P.active = false;
+}
@@ -0,0 +1,199 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>       /* tgamma */
+#include <list>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+#include "data.h"
+#include "output.h"
+#include "mcm_engine.h"
+
+/******************************************************************************/
+/**************************   FUNCTIONS USED   ********************************/
+/******************************************************************************/
+uint32_t transform_mu_basis(uint32_t mu, list<uint32_t> basis);
+
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best);
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r);
+
+/******************************************************************************/
+/*****************   HISTOGRAMS of ALL the ICCs over a WINDOW   ***************/
+/******************************************************************************/
+// For each possible part Ai of the r first basis elements, the histogram of the truncated states (s & Ai) of the datapoints
+// currently in the window is stored in a dense array of size 2^m (m = number of elements in Ai),
+// starting at Offset[Ai] in Counts (3^r counts in total).
+// SumLogG[Ai] = sum over the states of the ICC of [lgamma(K + 1/2) - log(pi)/2], which is 0 for the unobserved states;
+// it is updated each time a datapoint enters or leaves the window, only for the state of the ICC that has changed.
+
+struct Window_Marginals {
+    unsigned int r = n;           // number of basis elements
+    unsigned int W = 0;           // number of datapoints in the window
+
+    vector<size_t> Offset;        // Offset[Ai] = position of the histogram of Ai in Counts
+    vector<unsigned int> Counts;  // histograms of all the ICCs
+    vector<double> SumLogG;       // SumLogG[Ai]
+    vector<double> LogG;          // LogG[K] = lgamma(K + 1/2) - log(pi)/2
+};
+
+// *** Index of the truncated state (s & Ai) in the dense histogram of Ai (i.e. bits of s selected by Ai, packed on m bits):
+uint32_t Packed_State(uint32_t s, uint32_t Ai)
+{
+  uint32_t s_packed = 0, bit = 1;
+  for ( ; Ai != 0; Ai &= (Ai - 1), bit <<= 1)
+    {  if (s & Ai & (~Ai + 1))  {  s_packed |= bit;  }  }
+  return s_packed;
+}
+
+// *** The histograms of all the ICCs take Window_bytes_per_Count bytes for each of the 3^r counts:
+// *** MCM_SlidingWindow refuses a rank r for which they would take more than Window_max_memory:
+const unsigned int Window_bytes_per_Count = sizeof(unsigned int);
+const double Window_max_memory = 4e9;      // bytes
+
+Window_Marginals Create_Window_Marginals(unsigned int W_max, unsigned int r=n)
+{
+  Window_Marginals Window;
+  uint32_t Nsub = (1UL << r);
+
+  Window.r = r;
+  Window.Offset.assign(Nsub + 1, 0);
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+    {  Window.Offset[Ai+1] = Window.Offset[Ai] + (1UL << bitset<n>(Ai).count());  }
+
+  Window.Counts.assign(Window.Offset[Nsub], 0);
+  Window.SumLogG.assign(Nsub, 0);
+
+  Window.LogG.resize(W_max + 2);
+  for (unsigned int k=0; k<W_max+2; k++)  {  Window.LogG[k] = lgamma(k + 0.5) - 0.5 * log(M_PI);  }
+
+  return Window;
+}
+
+// *** Add the datapoint sig (written in the new basis) to the window:
+void Window_Add(Window_Marginals &Window, uint32_t sig)
+{
+  uint32_t Nsub = (1UL << Window.r);
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+  {
+    unsigned int &K = Window.Counts[Window.Offset[Ai] + Packed_State(sig, Ai)];
+    Window.SumLogG[Ai] += Window.LogG[K+1] - Window.LogG[K];
+    K++;
+  }
+  Window.W++;
+}
+
+// *** Remove the datapoint sig (written in the new basis) from the window:
+void Window_Remove(Window_Marginals &Window, uint32_t sig)
+{
+  uint32_t Nsub = (1UL << Window.r);
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)
+  {
+    unsigned int &K = Window.Counts[Window.Offset[Ai] + Packed_State(sig, Ai)];
+    Window.SumLogG[Ai] += Window.LogG[K-1] - Window.LogG[K];
+    K--;
+  }
+  Window.W--;
+}
+
+// *** Best MCM of rank r for the datapoints currently in the window:
+map<uint32_t, uint32_t> Window_BestMCM(const Window_Marginals &Window, double *LogE_best)
+{
+  uint32_t Nsub = (1UL << Window.r);
+  vector<double> LogE_table(Nsub, 0);
+  uint32_t m = 0;
+
+  for (uint32_t Ai = 1; Ai < Nsub; Ai++)      // LogE of each ICC (see LogE_ICC)
+  {
+    m = bitset<n>(Ai).count();
+    LogE_table[Ai] = Window.SumLogG[Ai] + lgamma((double)( 1UL << (m-1) )) - lgamma( (double)( Window.W + (1UL << (m-1)) ) );
+  }
+
+  map<uint32_t, uint32_t> Partition = MCM_SubsetDP(LogE_table, Window.r, LogE_best);
+  (*LogE_best) -= ((double) Window.W) * (n - Window.r) * log(2.);     // contribution of the non-modeled spins
+
+  return Partition;
+}
+
+/******************************************************************************/
+/***********************   SLIDING WINDOW: BEST MCMs   ************************/
+/******************************************************************************/
+// *** Rows = datapoints in their time order (see read_datafile_rows), written in the original basis;
+// *** Search for the best MCM of rank r = Config.r in each window of W consecutive datapoints, moving the window by `step` datapoints;
+// *** The datapoints are transformed in the new basis once, and the histograms of all the ICCs are updated incrementally:
+// *** only the datapoints entering and leaving the window are processed at each step.
+// *** One line per window is printed in the file "SlidingWindow_W=..._step=..._Rank_r=....dat" (if Config.print_files);
+// *** the function returns the number of windows.
+
+unsigned int MCM_SlidingWindow(const vector<uint32_t> &Rows, list<uint32_t> Basis, unsigned int W, unsigned int step, const MCM_Search_Config &Config)
+{
+  const unsigned int r = Config.r;
+  ostream Null_stream(NULL);
+  ostream &out = (Config.out != NULL) ? *Config.out : Null_stream;
+
+  out << "--->> Best MCM of rank r=" << r << " in a sliding window of W=" << W << " datapoints (step=" << step << ").." << endl;
+
+  if (step == 0 || W == 0 || W > Rows.size())  {  out << "--> Error: need 0 < W <= N and step > 0" << endl;  return 0;  }
+
+  double memory = (double) Window_bytes_per_Count * pow(3., r);
+  if (memory > Window_max_memory)
+  {
+    out << "--> Error: the histograms of the window for r=" << r << " would take " << memory / 1e9;
+    out << " GB (maximum: " << Window_max_memory / 1e9 << " GB); no window computed" << endl;
+    return 0;
+  }
+
+  // *** Change of basis (once per observed state):
+  map<uint32_t, uint32_t> sig_of_s;
+  vector<uint32_t> Sig(Rows.size());
+  for (unsigned int t=0; t<Rows.size(); t++)
+  {
+    map<uint32_t, uint32_t>::iterator it = sig_of_s.find(Rows[t]);
+    if (it == sig_of_s.end())  {  it = sig_of_s.insert(make_pair(Rows[t], transform_mu_basis(Rows[t], Basis))).first;  }
+    Sig[t] = it->second;
+  }
+
+  string filename = Config.output_directory + "SlidingWindow_W=" + to_string(W) + "_step=" + to_string(step) + "_Rank_r=" + to_string(r) + ".dat";
+  Output_File file_Window;
+  if (Config.print_files)  {  file_Window.open(filename);  }
+  file_Window << "# 1:first datapoint \t 2:last datapoint \t 3:Partition \t 4:LogE" << endl;
+
+  Window_Marginals Window = Create_Window_Marginals(W, r);
+  map<uint32_t, uint32_t> Partition;
+  double LogE = 0;
+  unsigned int counter = 0;
+
+  for (unsigned int t=0; t<W; t++)  {  Window_Add(Window, Sig[t]);  }
+
+  for (unsigned int t_start = 0; ; t_start += step)
+  {
+    // *** Best MCM of the window [t_start, t_start + W):
+    Partition = Window_BestMCM(Window, &LogE);
+    file_Window << t_start << " \t" << (t_start + W - 1) << " \t" << Partition_to_String(Partition, r) << " \t" << LogE << endl;
+    counter++;
+
+    if (t_start + step + W > Rows.size())  {  break;  }
+
+    // *** Slide the window:
+    for (unsigned int t = t_start; t < t_start + step; t++)
+    {
+      Window_Remove(Window, Sig[t]);
+      Window_Add(Window, Sig[t + W]);
+    }
+  }
+  file_Window.close();
+
+  out << "--> Number of windows: " << counter;
+  if (Config.print_files)  {  out << ", results printed in the file '" << filename << "'";  }
+  out << endl << endl;
+
+  return counter;
+}
+
+unsigned int MCM_SlidingWindow(const vector<uint32_t> &Rows, list<uint32_t> Basis, unsigned int W, unsigned int step=1, unsigned int r=n)
+{
+  MCM_Search_Config Config;
+  Config.r = r;
+  return MCM_SlidingWindow(Rows, Basis, W, step, Config);
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <bitset>
+#include <cmath>
+
+using namespace std;
+
+#include "tiered_cache.h"
+
+atomic<size_t> LogE_cache_memory(1UL << 30);
+
+/******************************************************************************/
+/***************************   CONSTRUCTOR   **********************************/
+/******************************************************************************/
+// *** Choice of the tiers: all the 2^r parts in the dense tier if they fit in the budget;
+// *** otherwise the parts with at most k elements in at most half of the budget, and the rest of the budget for the hash tier:
+Tiered_LogE_Cache::Tiered_LogE_Cache(unsigned int r_, size_t memory_budget)
+  : r(r_), k(0), Dense_size(1), log2_buckets(0), N_buckets(0), hits_dense(0), hits_hash(0), misses(0), evictions(0)
+{
+  for (unsigned int i=0; i<=32; i++)
+    {  for (unsigned int j=0; j<=32; j++)  {  Binomial[i][j] = (j == 0) ? 1 : ((i == 0) ? 0 : Binomial[i-1][j-1] + Binomial[i-1][j]);  }  }
+
+  // *** Dense tier (Dense_size = number of parts with at most k elements, including the empty part):
+  size_t max_dense = memory_budget / sizeof(atomic<double>);
+  if (r < 64 && (((size_t) 1) << r) <= max_dense)  {  k = r;  }
+  else  {  max_dense /= 2;  }
+
+  Dense_offset[0] = 0;
+  for (unsigned int m=0; m<=r; m++)
+  {
+    Dense_offset[m+1] = Dense_offset[m] + Binomial[r][m];
+    if (m > k && Dense_offset[m+1] <= max_dense)  {  k = m;  }
+  }
+  if (Dense_offset[1] > max_dense)  {  k = 0;  }        // too small budget: no dense tier (except the empty part)
+  Dense_size = Dense_offset[k+1];        // = 2^r if k = r: the index of Ai is then Ai itself (see Dense_Index)
+
+  Dense.reset(new atomic<double>[Dense_size]);
+  for (size_t i=0; i<Dense_size; i++)  {  Dense[i].store(NAN, memory_order_relaxed);  }
+
+  // *** Hash tier, in the rest of the budget:
+  if (k < r)
+  {
+    size_t memory_hash = (memory_budget > Dense_size * sizeof(atomic<double>)) ? memory_budget - Dense_size * sizeof(atomic<double>) : 0;
+    size_t memory_bucket = Bucket_size * sizeof(Slot) + sizeof(uint8_t);
+    while ( (((size_t) 2) << log2_buckets) * memory_bucket <= memory_hash )  {  log2_buckets++;  }
+    if ( memory_bucket <= memory_hash )  {  N_buckets = ((size_t) 1) << log2_buckets;  }
+
+    Buckets.reset(new Slot[N_buckets * Bucket_size]);
+    Next_victim.reset(new uint8_t[N_buckets]);
+    for (size_t i=0; i<N_buckets * Bucket_size; i++)  {  Buckets[i].Ai = 0;  Buckets[i].LogE = 0;  }
+    for (size_t i=0; i<N_buckets; i++)  {  Next_victim[i] = 0;  }
+  }
+}
+
+/******************************************************************************/
+/****************************   INDICES   *************************************/
+/******************************************************************************/
+// *** Index of the part Ai with m elements in the dense tier: Dense_offset[m] + rank of Ai among the parts with m elements
+// *** (rank in the colexicographic order: sum of Binomial[p][i+1] over the positions p_0 < p_1 < ... of the elements of Ai);
+// *** or simply Ai if all the 2^r parts are in the dense tier:
+size_t Tiered_LogE_Cache::Dense_Index(uint32_t Ai, unsigned int m) const
+{
+  if (k == r)  {  return Ai;  }     // all the parts are in the dense tier
+  size_t index = Dense_offset[m];
+  for (unsigned int i=1; Ai != 0; Ai &= (Ai - 1), i++)
+    {  index += Binomial[__builtin_ctz(Ai)][i];  }
+  return index;
+}
+
+size_t Tiered_LogE_Cache::Bucket_Index(uint32_t Ai) const
+{
+  if (log2_buckets == 0)  {  return 0;  }
+  return (size_t) ((Ai * 0x9E3779B97F4A7C15ULL) >> (64 - log2_buckets));     // multiplicative hash
+}
+
+/******************************************************************************/
+/**************************   FIND / INSERT   *********************************/
+/******************************************************************************/
+bool Tiered_LogE_Cache::Find(uint32_t Ai, double *LogE)
+{
+  unsigned int m = (k == r) ? 0 : bitset<32>(Ai).count();
+
+  if (m <= k)         // *** dense tier:
+  {
+    double value = Dense[Dense_Index(Ai, m)].load(memory_order_relaxed);
+    if (std::isnan(value))  {  misses.fetch_add(1, memory_order_relaxed);  return false;  }
+    hits_dense.fetch_add(1, memory_order_relaxed);
+    *LogE = value;
+    return true;
+  }
+
+  if (N_buckets > 0)  // *** hash tier:
+  {
+    size_t b = Bucket_Index(Ai);
+    lock_guard<mutex> lock(Locks[b % N_locks]);
+    const Slot *Bucket = &Buckets[b * Bucket_size];
+    for (unsigned int i=0; i<Bucket_size; i++)
+    {
+      if (Bucket[i].Ai == Ai)
+        {  hits_hash.fetch_add(1, memory_order_relaxed);  *LogE = Bucket[i].LogE;  return true;  }
+    }
+  }
+
+  misses.fetch_add(1, memory_order_relaxed);
+  return false;
+}
+
+void Tiered_LogE_Cache::Insert(uint32_t Ai, double LogE)
+{
+  unsigned int m = (k == r) ? 0 : bitset<32>(Ai).count();
+
+  if (m <= k)  {  Dense[Dense_Index(Ai, m)].store(LogE, memory_order_relaxed);  return;  }
+  if (N_buckets == 0)  {  return;  }
+
+  size_t b = Bucket_Index(Ai);
+  lock_guard<mutex> lock(Locks[b % N_locks]);
+  Slot *Bucket = &Buckets[b * Bucket_size];
+
+  for (unsigned int i=0; i<Bucket_size; i++)            // already inserted (by another thread), or empty slot
+  {
+    if (Bucket[i].Ai == Ai || Bucket[i].Ai == 0)  {  Bucket[i].Ai = Ai;  Bucket[i].LogE = LogE;  return;  }
+  }
+
+  // *** Full bucket: replace its parts in turn:
+  unsigned int i = Next_victim[b];
+  Next_victim[b] = (i + 1) % Bucket_size;
+  Bucket[i].Ai = Ai;  Bucket[i].LogE = LogE;
+  evictions.fetch_add(1, memory_order_relaxed);
+}
+
+/******************************************************************************/
+/*****************************   STATISTICS   *********************************/
+/******************************************************************************/
+Tiered_Cache_Stats Tiered_LogE_Cache::Stats() const
+{
+  Tiered_Cache_Stats S;
+  S.hits_dense = hits_dense.load();
+  S.hits_hash = hits_hash.load();
+  S.misses = misses.load();
+  S.evictions = evictions.load();
+  S.k = k;
+  S.dense_size = Dense_size;
+  S.hash_slots = N_buckets * Bucket_size;
+  S.memory = Dense_size * sizeof(atomic<double>) + N_buckets * (Bucket_size * sizeof(Slot) + sizeof(uint8_t));
+  return S;
+}
@@ -6,8 +6,11 @@ using namespace std;
 /**************************    CONSTANTS    *************************/
 /********************************************************************/
 
-// number of binary (spin) variables:
-const unsigned int n = 9; 
+// number of binary (spin) variables (can be changed at compilation with the option -DMCM_N=..., e.g. for the benchmark):
+#ifndef MCM_N
+#define MCM_N 9
+#endif
+const unsigned int n = MCM_N; 
 
 
 // (optional) INPUT FILES:
@@ -3,6 +3,9 @@
 #include <map>
 #include <vector>
 
+#include "partition.h"
+#include "mcm_engine.h"
+
 /******************************************************************************/
 /******************************************************************************/
 /*********************     SPECIFY the BASIS    *******************************/
@@ -18,6 +21,20 @@ list<uint32_t> Original_Basis();   // return the original basis, i.e., {s1, s2,
 list<uint32_t> Read_BasisOp_BinaryRepresentation(string Basis_binary_filename = basis_BinaryRepresentation_filename);   // default filename to specify in data.h
 list<uint32_t> Read_BasisOp_IntegerRepresentation(string Basis_integer_filename = basis_IntegerRepresentation_filename); 
 
+/*** SEARCH for the BEST BASIS:    *******************************************/
+/******************************************************************************/
+// *** Set of m independent operators with the smallest sum of entropies (greedy selection by increasing entropy,
+// *** with the statistics of all the operators computed once from the data); can be used directly with build_Kset().
+// *** Needs 12 bytes per operator (2^n operators): returns an empty basis if n is too large for the memory:
+list<uint32_t> Find_Best_Basis(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, unsigned int m=n, bool print_bool=false);
+
+// *** Statistics of all the operators: Op_Sum[Op] = sum over the datapoints of phi_Op(s) = +/-1; and entropy of an operator:
+vector<int64_t> Operator_Statistics(const vector<pair<uint32_t, unsigned int>> &Nset);
+double Operator_Entropy(int64_t Op_Sum, unsigned int N);
+
+// *** Check that the operators are independent (i.e. none of them is a product of the others):
+bool Check_Independent_Operators(list<uint32_t> Basis_li);
+
 /*** Print Basis Info in the Terminal:    *************************************/
 /******************************************************************************/
 void PrintTerm_Basis(list<uint32_t> Basis_li);
@@ -33,6 +50,9 @@ void PrintTerm_Basis(list<uint32_t> Basis_li);
 /******************************************************************************/
 vector<pair<uint32_t, unsigned int>> read_datafile(unsigned int *N, string filename = datafilename);  // filename to specify in data.h
 
+// *** Same, but keep the datapoints in the order of the file (e.g. time series); Rows[t] = t-th datapoint:
+vector<uint32_t> read_datafile_rows(unsigned int *N, string filename = datafilename);
+
 /*** DATA CHANGE of BASIS:    *************************************************/
 /******************************************************************************/
 // *** Build Kset with the following definitions:
@@ -73,6 +93,19 @@ double Complexity_MCM(map<uint32_t, uint32_t> Partition, unsigned int N, double
 double LogL_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N);
 double LogE_MCM(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N);
 
+/**********************    LogE for a Dirichlet prior     *********************/
+/******************************************************************************/
+// *** Symmetric Dirichlet prior of parameter alpha on the states of each ICC (alpha = 0.5: Jeffreys prior, same as LogE_ICC):
+double LogE_ICC_alpha(vector<pair<uint32_t, unsigned int>> Kset, uint32_t Ai, unsigned int N, double alpha);
+double LogE_MCM_alpha(vector<pair<uint32_t, unsigned int>> Kset, map<uint32_t, uint32_t> Partition, unsigned int N, double alpha);
+
+/*************************    Held-out LogL     *******************************/
+/******************************************************************************/
+// *** LogL of the test data `Kset_test` for the MCM with parameters learned on `Kset_train` 
+// *** (probabilities of each part estimated with the Jeffreys prior, so that unseen states have a finite contribution):
+double LogL_ICC_HeldOut(const vector<pair<uint32_t, unsigned int>> &Kset_train, unsigned int N_train, const vector<pair<uint32_t, unsigned int>> &Kset_test, uint32_t Ai);
+double LogL_MCM_HeldOut(const vector<pair<uint32_t, unsigned int>> &Kset_train, unsigned int N_train, const vector<pair<uint32_t, unsigned int>> &Kset_test, unsigned int N_test, map<uint32_t, uint32_t> Partition);
+
 
 
 /******************************************************************************/
@@ -132,6 +165,249 @@ map<uint32_t, uint32_t> MCM_AllRank_SmallerThan_r_Ordered(vector<pair<uint32_t,
 // ***             - the function doesn't print the logE-values for all the tested MCMs. To activate --> print_bool = true 
 map<uint32_t, uint32_t> MCM_AllRank_SmallerThan_r_nonOrdered(vector<pair<uint32_t, unsigned int>> Kset, unsigned int N, double *LogE_best, unsigned int r=n, bool print_bool=false);
 
+/******************************************************************************/
+// *** Top candidates:
+// ***            Compare all the MCMs of rank r (as in Version 1) and return the `n_top` MCMs with the largest LogE,
+// ***            sorted by decreasing LogE (.first = LogE, .second = partition). Nothing is printed.
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_TopCandidates(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int n_top, unsigned int r=n);
+
+// *** Write a partition of the r first basis elements as a string of digits (same format as in the output files):
+string Partition_to_String(map<uint32_t, uint32_t> Partition, unsigned int r=n);
+
+/******************************************************************************/
+// *** Compact partitions:  (type Partition_t and conversions to/from map<uint32_t, uint32_t> in the file "partition.h")
+// ***            Same functions as above for a Partition_t, used in the loops of the searches (no memory allocation per partition):
+double LogE_MCM(const vector<pair<uint32_t, unsigned int>> &Kset, const Partition_t &Partition, unsigned int N);
+double LogL_MCM(const vector<pair<uint32_t, unsigned int>> &Kset, const Partition_t &Partition, unsigned int N);
+double Complexity_MCM(const Partition_t &Partition, unsigned int N, double *C_param, double *C_geom);
+pair<bool, uint32_t> check_partition(const Partition_t &Partition);
+string Partition_to_String(const Partition_t &Partition, unsigned int r=n);
+
+// *** Partition of the r first basis elements for the restricted growth string a[0..r-1] (as Convert_Partition_forMCM):
+Partition_t Convert_Partition_forMCM_compact(const uint32_t *a, unsigned int r=n);
+
+/******************************************************************************/
+// *** Dynamic programming over subsets:  (functions in the file "Best_MCM_SubsetDP.cpp")
+// ***            Same result as Version 1, but goes through the 3^r pairs (set, subset) instead of the Bell(r) partitions;
+// ***            uses 2^r values of LogE (one per possible ICC); nothing is printed in files.
+
+// *** LogE_table[Ai] = LogE_ICC(Kset, Ai, N), for all the parts Ai of the r first basis elements (1 <= Ai < 2^r):
+vector<double> LogE_AllSubsets(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n);
+
+// *** Partition of the r first basis elements that maximizes the sum of the values Score_table[Ai] of its parts
+// *** (parts with a value of -INFINITY are never selected):
+map<uint32_t, uint32_t> MCM_SubsetDP(const vector<double> &Score_table, unsigned int r, double *Score_best);
+
+map<uint32_t, uint32_t> MCM_GivenRank_r_SubsetDP(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int r=n);
+map<uint32_t, uint32_t> MCM_GivenRank_r_SubsetDP(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, const MCM_Search_Config &Config);
+
+// *** Best MCM of every rank r = 1, ..., R (based on the r first basis elements), from a single table and a single DP pass;
+// *** Results[r-1] = (LogE, best MCM of rank r); printed in the file "BestMCM_NestedRanks_R=....dat":
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_NestedRanks(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int R=n);
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_NestedRanks(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const MCM_Search_Config &Config);   // R = Config.r
+
+/******************************************************************************/
+// *** Several criteria at once:  (function in the file "Best_MCM_MultiCriteria.cpp")
+// ***            Compare all the MCM of rank r (as Version 1) and keep, in the same pass, the best MCM for each criterion:
+// ***            "LogE", "MDL" (= LogL - C_param - C_geom), "BIC" (= LogL - K/2 log(N), K = number of parameters),
+// ***            and "LogL_test" (held-out LogL, only if a test set is given); the values of the criteria for all the ICCs are computed once.
+// ***            Returns, for each criterion: (value, best MCM); printed in the file "BestMCM_Rank_r=..._MultiCriteria.dat".
+map<string, pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_MultiCriteria(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n, const vector<pair<uint32_t, unsigned int>> &Kset_test = vector<pair<uint32_t, unsigned int>>(), unsigned int N_test=0);
+map<string, pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_MultiCriteria(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const MCM_Search_Config &Config, const vector<pair<uint32_t, unsigned int>> &Kset_test = vector<pair<uint32_t, unsigned int>>(), unsigned int N_test=0);
+
+/******************************************************************************/
+// *** Grid of Dirichlet priors:  (functions in the file "Best_MCM_PriorGrid.cpp")
+// ***            Compare all the MCM of rank r (as Version 1) with the LogE computed for all the values of alpha in Alpha
+// ***            (see LogE_ICC_alpha) in the same pass. Returns, for each alpha: (LogE of the best MCM, best MCM);
+// ***            printed in the file "BestMCM_Rank_r=..._PriorGrid.dat".
+vector<double> LogE_AllSubsets_alpha(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const vector<double> &Alpha, unsigned int r=n);
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_PriorGrid(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const vector<double> &Alpha, unsigned int r=n);
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_GivenRank_r_PriorGrid(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, const vector<double> &Alpha, const MCM_Search_Config &Config);
+
+/******************************************************************************/
+// *** Search with constraints:  (functions in the file "Best_MCM_Constrained.cpp")
+// ***            Only the MCMs that satisfy the constraints are visited: at most max_size operators per part,
+// ***            operators of the pairs in `Together` in the same part, operators of the pairs in `Apart` in different parts
+// ***            (operators given by their position in the basis, from 0 to r-1; 0 = bit the most on the right).
+// ***            Return an empty partition if no MCM satisfies the constraints.
+map<uint32_t, uint32_t> MCM_GivenRank_r_Constrained(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int max_size, const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, unsigned int r=n);
+map<uint32_t, uint32_t> MCM_GivenRank_r_Constrained(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int max_size, const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, const MCM_Search_Config &Config);
+
+// *** Same, with the dynamic programming over subsets (the disallowed parts get a LogE of -INFINITY and are not computed):
+vector<double> LogE_AllSubsets_Constrained(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int max_size, const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, unsigned int r=n);
+map<uint32_t, uint32_t> MCM_GivenRank_r_SubsetDP_Constrained(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int max_size, const vector<pair<unsigned int, unsigned int>> &Together, const vector<pair<unsigned int, unsigned int>> &Apart, unsigned int r=n);
+
+/******************************************************************************/
+// *** Persistent cache of the ICCs:  (functions in the file "ICC_PersistentCache.cpp", POSIX systems only)
+// ***            LogE (and LogL) of all the ICCs of the r first elements of `Basis`, for the data Nset (written in the original basis);
+// ***            the ICCs are stored in the file `cache_filename` (memory-mapped hash table with 2^log2_capacity entries),
+// ***            identified by a fingerprint of the dataset and the set of operators of the ICC: the ICCs already in the file
+// ***            (from any previous run, basis or rank) are not recomputed. The file can be shared by programs running at the same time.
+vector<double> LogE_AllSubsets_PersistentCache(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, list<uint32_t> Basis, string cache_filename, unsigned int r=n, vector<double> *LogL_table=NULL, unsigned int log2_capacity=20);
+map<uint32_t, uint32_t> MCM_GivenRank_r_PersistentCache(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, list<uint32_t> Basis, double *LogE_best, string cache_filename, unsigned int r=n);
+
+/******************************************************************************/
+// *** Progress of the long searches:  (functions in the file "Progress.cpp")
+// ***            Versions 1, 2 and 3 and MCM_GivenRank_r_Specialized report, every `interval` seconds, the number of MCMs visited,
+// ***            the percentage of the Bell(r) MCMs of rank r, the number of MCMs per second, the best LogE so far and the remaining time;
+// ***            the reports are printed in the standard error, or written in the file `status_filename` (re-written at each report) if given.
+// *** By default: interval = 10 seconds, in the standard error; interval <= 0 turns the reports off.
+void Set_Progress_Report(double interval, string status_filename = "");
+
+// *** Number of MCMs of rank r (Bell number):
+double Bell_number(unsigned int r);
+
+/******************************************************************************/
+// *** Profiling:  (functions in the file "Profiling.cpp")
+// ***            Time spent in each phase (reading, build_Kset, PrintInfo_All_*, searches, PrintFile_*) and number of events
+// ***            (ICC evaluations, cache hits, map allocations, bytes written), written in the JSON file `filename` at the end of the program;
+// ***            with hardware_counters = true, the cycles, instructions and cache misses of the searches are also read (Linux only, with perf_event_open).
+// *** Can also be turned on with the environment variable MCM_PROFILE=1 (or MCM_PROFILE=hw for the hardware counters), without recompiling.
+void Set_Profiling(bool enabled, bool hardware_counters = false, string filename = OUTPUT_directory + "Profile.json");
+
+/******************************************************************************/
+// *** Search engine:  (class MCM_Search_Engine in the file "mcm_engine.h", functions in the file "MCM_Engine.cpp")
+// *** Versions 1, 2 and 3 with their own settings (rank, output folder, output stream, progress report) instead of global variables,
+// *** so that several searches can run at the same time; the functions MCM_GivenRank_r, MCM_AllRank_SmallerThan_r_Ordered
+// *** and MCM_AllRank_SmallerThan_r_nonOrdered above use an engine with the default settings (MCM_Search_Config).
+// *** The other searches (SubsetDP, NestedRanks, MultiCriteria, PriorGrid, Constrained, Specialized, Anytime, Annealing,
+// *** Batch_Bases, CrossValidation, Bootstrap, SlidingWindow) also take a MCM_Search_Config instead of the rank r:
+// *** their files are printed in Config.output_directory (or not at all if print_files = false), their messages in Config.out;
+// *** the versions with the rank r use the default settings (OUTPUT_directory, cout).
+// *** The default settings (Set_Progress_Report, Set_Output, LogE_cache_memory) can be changed while other threads run searches.
+/******************************************************************************/
+
+/******************************************************************************/
+// *** Projection of Kset on the ICCs:  (functions in the file "ICC_Projection.cpp")
+// *** LogE_AllSubsets (above) and LogE_ICC_Sorted use these functions; they give the same values as LogE_ICC (to the last bit):
+// ***   - sparse method, for few distinct states (|Kset| << 2^r): the states sorted for a part are only split in two for a part with one more element;
+// ***   - dense method, for |Kset| close to 2^r: the histogram of a part is obtained from the histogram of a part with one more element.
+vector<double> LogE_AllSubsets_Sparse(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n);
+vector<double> LogE_AllSubsets_Dense(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n);
+vector<double> LogE_AllSubsets_Projected(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int r=n);   // chooses the method
+
+/******************************************************************************/
+// *** Cache of the LogE of the ICCs:  (class Tiered_LogE_Cache in the file "tiered_cache.h", functions in the file "Tiered_Cache.cpp")
+// *** Used by the search engine (Versions 1, 2 and 3) and by MCM_GivenRank_r_TopCandidates, within a memory budget
+// *** (the global variable LogE_cache_memory, 1 GB by default, or MCM_Search_Config::cache_memory):
+// *** the small parts are kept in a dense array, the larger ones in a hash table of fixed size (the oldest entries of a bucket are replaced).
+// *** MCM_Search_Engine::Cache_Stats() gives the numbers of hits (in each tier), misses and replaced entries.
+/******************************************************************************/
+
+/******************************************************************************/
+// *** Output files:  (class Output_File in the file "output.h", functions in the file "Output.cpp")
+// *** All the files printed by the PrintFile_* functions and by the searches are written through a large buffer (no flush at each line),
+// *** and the doubles are written with the shortest number of digits that gives back exactly the same value;
+// *** buffer size in bytes (1 MB by default), and writer_thread = true to write the full buffers in a second thread:
+void Set_Output(size_t buffer_size, bool writer_thread = false);
+
+/******************************************************************************/
+// *** Version 1 specialized on the rank:  (function in the file "Best_MCM_Specialized.cpp")
+// ***            Same result and same printed files as MCM_GivenRank_r, with a kernel compiled for each rank 2 <= r <= 20
+// ***            (fixed-size arrays, LogE of each part computed once); calls MCM_GivenRank_r for the other values of r.
+map<uint32_t, uint32_t> MCM_GivenRank_r_Specialized(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int r=n, bool print_bool=false);
+map<uint32_t, uint32_t> MCM_GivenRank_r_Specialized(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, const MCM_Search_Config &Config);
+
+/******************************************************************************/
+// *** Anytime search:  (function in the file "Best_MCM_Anytime.cpp")
+// ***            Best MCM of rank r found within `time_budget` seconds: first greedy searches (from the independent model,
+// ***            the complete model, and greedy merges of the parts), then the exact search by dynamic programming if time allows.
+// ***            *LogE_bound = upper bound on the LogE of the best MCM of rank r (at least as tight as the max-likelihood LogL
+// ***            of the complete model; equal to *LogE_best if the search was completed).
+map<uint32_t, uint32_t> MCM_Anytime(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, double *LogE_bound, double time_budget, unsigned int r=n);
+map<uint32_t, uint32_t> MCM_Anytime(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, double *LogE_bound, double time_budget, const MCM_Search_Config &Config);
+
+/******************************************************************************/
+// *** Simulated annealing:  (function in the file "Best_MCM_Annealing.cpp")
+// ***            For ranks too large for the exhaustive searches: n_chains independent chains (0 = one per thread), run on n_threads threads,
+// ***            each restarted n_restarts times from a random partition, with n_steps random moves (move of an operator, merge, split);
+// ***            the LogE of the parts is kept in a lock-free table shared by the chains (2^log2_cache_size entries).
+// ***            The best MCM of each chain is printed in the file "BestMCM_Rank_r=..._Annealing.dat".
+map<uint32_t, uint32_t> MCM_GivenRank_r_Annealing(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, unsigned int r=n, unsigned int n_steps=100000, unsigned int n_restarts=10, unsigned int n_chains=0, unsigned int n_threads=0, unsigned int log2_cache_size=20, unsigned int seed=1);
+map<uint32_t, uint32_t> MCM_GivenRank_r_Annealing(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogE_best, const MCM_Search_Config &Config, unsigned int n_steps=100000, unsigned int n_restarts=10, unsigned int n_chains=0, unsigned int n_threads=0, unsigned int log2_cache_size=20, unsigned int seed=1);
+
+/******************************************************************************/
+// *** Incremental search after a change of basis:  (function in the file "Basis_Incremental.cpp")
+// ***            Best MCM of rank r in the basis `Basis`, directly from Nset (no need to build Kset).
+// ***            LogE_cache[set of operators of an ICC] = LogE of the ICC, is kept between calls (for a same dataset):
+// ***            only the ICCs that are not yet in the cache are computed, e.g. only the ICCs containing 
+// ***            the operator that was swapped or appended to the basis since the previous call. Nothing is printed.
+map<uint32_t, uint32_t> MCM_Basis_Incremental(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, list<uint32_t> Basis, map<vector<uint32_t>, double> &LogE_cache, double *LogE_best, unsigned int r=n);
+
+
+/******************************************************************************/
+/******************************************************************************/
+/*********************   SCREEN MANY CANDIDATE BASES   ************************/
+/******************************************************************************/
+/******************************************************************************/
+// *** Functions in the file "Basis_Batch.cpp":
+
+// *** Read a list of basis filenames (one per line; each basis file in the binary representation):
+vector<string> Read_Basis_Filenames(string list_filename);
+
+// *** Histograms of the data in all the bases at once (single pass over Nset, shared operators evaluated once):
+vector<vector<pair<uint32_t, unsigned int>>> build_Kset_ManyBases(const vector<pair<uint32_t, unsigned int>> &Nset, const vector<list<uint32_t>> &Bases);
+
+// *** Best MCM of rank r in each basis, searched in parallel on n_threads threads (0 = number of hardware threads);
+// *** prints a summary ranked by LogE in the file "BatchBases_Summary.dat"; returns (LogE, best MCM) for each basis:
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_Batch_Bases(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, const vector<list<uint32_t>> &Bases, const vector<string> &Basis_names, unsigned int r=n, unsigned int n_threads=0);
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_Batch_Bases(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, const vector<list<uint32_t>> &Bases, const vector<string> &Basis_names, const MCM_Search_Config &Config, unsigned int n_threads=0);
+vector<pair<double, map<uint32_t, uint32_t>>> MCM_Batch_Bases(const vector<pair<uint32_t, unsigned int>> &Nset, unsigned int N, string list_filename, unsigned int r=n, unsigned int n_threads=0);
+
+
+/******************************************************************************/
+/******************************************************************************/
+/************************   k-FOLD CROSS-VALIDATION   *************************/
+/******************************************************************************/
+/******************************************************************************/
+// *** Functions in the file "CrossValidation.cpp":
+
+// *** Split the datapoints of Nset in k folds (reproducible for a given seed), and return the histogram of each fold in the new basis:
+// ***      N_fold[f] = number of datapoints in fold f.
+vector<vector<pair<uint32_t, unsigned int>>> build_Kset_Folds(const vector<pair<uint32_t, unsigned int>> &Nset, list<uint32_t> Basis, unsigned int k_folds, vector<unsigned int> &N_fold, uint64_t seed = 1);
+
+// *** Training histogram = Kset minus the held-out histogram Kset_test:
+vector<pair<uint32_t, unsigned int>> Subtract_Kset(const vector<pair<uint32_t, unsigned int>> &Kset, const vector<pair<uint32_t, unsigned int>> &Kset_test);
+
+// *** Compare the `n_top` best MCMs of rank r (according to their LogE) using k-fold cross-validation (folds evaluated in parallel);
+// ***      Kset must be the histogram of Nset in the basis `Basis` (i.e. the output of build_Kset(Nset, Basis));
+// ***      returns the MCM with the largest held-out LogL, summed over the folds (stored in *LogL_test_best).
+map<uint32_t, uint32_t> MCM_CrossValidation(const vector<pair<uint32_t, unsigned int>> &Nset, list<uint32_t> Basis, const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogL_test_best, unsigned int k_folds=5, unsigned int n_top=10, unsigned int r=n, uint64_t seed=1);
+map<uint32_t, uint32_t> MCM_CrossValidation(const vector<pair<uint32_t, unsigned int>> &Nset, list<uint32_t> Basis, const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *LogL_test_best, unsigned int k_folds, unsigned int n_top, const MCM_Search_Config &Config, uint64_t seed=1);
+
+
+/******************************************************************************/
+/******************************************************************************/
+/************************   BOOTSTRAP of the BEST MCM   ***********************/
+/******************************************************************************/
+/******************************************************************************/
+// *** Functions in the file "Bootstrap.cpp":
+
+// *** B multinomial resamplings of the histogram Kset: Kset_boot[i*B + b] = count of the state Kset[i].first in the replicate b:
+vector<unsigned int> Bootstrap_Kset(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, unsigned int B, uint64_t seed = 1);
+
+// *** LogE of all the possible ICCs for all the replicates at once: LogE_table[Ai*B + b]
+vector<double> LogE_AllSubsets_Bootstrap(const vector<pair<uint32_t, unsigned int>> &Kset, const vector<unsigned int> &Kset_boot, unsigned int N, unsigned int B, unsigned int r=n);
+
+// *** Best MCM of rank r in each of the B replicates; prints how often each MCM, and each pair of operators in the same ICC, wins;
+// *** returns the MCM that wins most often:
+map<uint32_t, uint32_t> MCM_Bootstrap(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *Freq_best, unsigned int B=100, unsigned int r=n, uint64_t seed=1);
+map<uint32_t, uint32_t> MCM_Bootstrap(const vector<pair<uint32_t, unsigned int>> &Kset, unsigned int N, double *Freq_best, unsigned int B, const MCM_Search_Config &Config, uint64_t seed=1);
+
+
+/******************************************************************************/
+/******************************************************************************/
+/*****************   SLIDING WINDOW (time-ordered data)   *********************/
+/******************************************************************************/
+/******************************************************************************/
+// *** Functions in the file "Streaming.cpp":
+
+// *** Best MCM of rank r in each window of W consecutive datapoints of `Rows` (see read_datafile_rows), moving by `step` datapoints;
+// *** prints one line per window in the file "SlidingWindow_W=[W]_step=[step]_Rank_r=[r].dat"; returns the number of windows
+// *** (0, and no file, if W or step are not valid or if the 3^r counts of the window would take more than 4 GB):
+unsigned int MCM_SlidingWindow(const vector<uint32_t> &Rows, list<uint32_t> Basis, unsigned int W, unsigned int step=1, unsigned int r=n);
+unsigned int MCM_SlidingWindow(const vector<uint32_t> &Rows, list<uint32_t> Basis, unsigned int W, unsigned int step, const MCM_Search_Config &Config);
+
 
 /******************************************************************************/
 /******************************************************************************/
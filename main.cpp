@@ -1,4 +1,4 @@
-// To compile: g++ -std=c++11 -O3 main.cpp Data_Manipulation.cpp LogL_LogE.cpp Complexity.cpp Basis_Choice.cpp MCM_info.cpp P_s.cpp Best_MCM.cpp
+// To compile: g++ -std=c++11 -O3 -pthread main.cpp Data_Manipulation.cpp LogL_LogE.cpp Complexity.cpp Basis_Choice.cpp MCM_info.cpp P_s.cpp Best_MCM.cpp Best_MCM_SubsetDP.cpp CrossValidation.cpp Bootstrap.cpp Streaming.cpp Basis_Incremental.cpp Basis_Batch.cpp Best_MCM_Anytime.cpp Best_MCM_Annealing.cpp Best_MCM_Constrained.cpp Best_MCM_MultiCriteria.cpp Best_MCM_PriorGrid.cpp ICC_PersistentCache.cpp Best_MCM_Specialized.cpp Progress.cpp Profiling.cpp MCM_CAPI.cpp MCM_Engine.cpp ICC_Projection.cpp Tiered_Cache.cpp Output.cpp
 // To run: time ./a.out
 //
 #include <iostream>
@@ -69,6 +69,9 @@ int main()
 //   list<uint32_t> Basis_li = Read_BasisOp_IntegerRepresentation();
    list<uint32_t> Basis_li = Read_BasisOp_BinaryRepresentation();
 
+  // *** Or the best basis can be searched directly from the data:
+//   list<uint32_t> Basis_li = Find_Best_Basis(Nset, N, n, true);
+
   // *** Print info about the Basis:
   PrintTerm_Basis(Basis_li);
 
@@ -262,6 +265,25 @@ int main()
   else { cout << "The condition on the value of 'r' is not respected" << endl;  }
 
 
+  cout << endl << "*******************************************************************************************"; 
+  cout << endl << "*****************************  k-FOLD CROSS-VALIDATION:  **********************************";
+  cout << endl << "*************  Compare the best MCMs of rank 'r' by their held-out log-likelihood  *********";
+  cout << endl << "*******************************************************************************************" << endl;
+
+  cout << endl << "/!\\ INFORMATION:"; 
+  cout << endl << "\tThe data is split once in 'k' folds; for each fold, the parameters of the MCMs are learned on the other folds,";
+  cout << endl << "\tand their log-likelihood is computed on the held-out fold (the folds are evaluated in parallel)." << endl << endl;
+
+  int r_CV = 9;
+  double LogL_test_best = 0;
+
+  if (r_CV <= Basis_li.size())
+  {
+    map<uint32_t, uint32_t> MCM_Partition_CV = MCM_CrossValidation(Nset, Basis_li, Kset, N, &LogL_test_best, 5, 10, r_CV);
+  }
+  else { cout << "The condition on the value of 'r' is not respected" << endl;  }
+
+
   cout << endl << "*******************************************************************************************"; 
   cout << endl << "***********************************    PRINT TO FILE    ***********************************";
   cout << endl << "****************************    DATA VS MODEL PROBABILITIES:    ***************************";
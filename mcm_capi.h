@@ -0,0 +1,77 @@
+/******************************************************************************/
+/*************************   C INTERFACE (C ABI)   ****************************/
+/******************************************************************************/
+/* Search for the best MCM from a histogram already in memory (no datafile, no data.h paths),
+ * callable from C or from any language with a C foreign function interface.
+ *
+ * To build the shared library (the functions are defined in MCM_CAPI.cpp):
+ *   g++ -std=c++11 -O3 -pthread -fPIC -shared -o libmcm.so MCM_CAPI.cpp Data_Manipulation.cpp LogL_LogE.cpp Complexity.cpp Basis_Choice.cpp MCM_info.cpp P_s.cpp Best_MCM.cpp Best_MCM_SubsetDP.cpp CrossValidation.cpp Bootstrap.cpp Streaming.cpp Basis_Incremental.cpp Basis_Batch.cpp Best_MCM_Anytime.cpp Best_MCM_Annealing.cpp Best_MCM_Constrained.cpp Best_MCM_MultiCriteria.cpp Best_MCM_PriorGrid.cpp ICC_PersistentCache.cpp Best_MCM_Specialized.cpp Progress.cpp Profiling.cpp MCM_Engine.cpp ICC_Projection.cpp Tiered_Cache.cpp Output.cpp
+ *
+ * The histogram is given in the basis in which the MCMs are searched (i.e. as a Kset: bit i of a state = operator i+1 of the basis);
+ * the MCMs of rank r are built on the r first operators (bits 0 to r-1).
+ * The arrays of the histogram belong to the caller, and must not change during a call;
+ * each call copies the observed states once (O(K) memory, for K observed states).
+ * The functions print nothing (neither in the terminal nor in files).
+ */
+
+#ifndef MCM_CAPI_H
+#define MCM_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MCM_CAPI_VERSION 1
+
+/* Return codes: */
+#define MCM_OK                 0
+#define MCM_ERROR_ARGUMENT    -1     /* NULL pointer, empty histogram, or invalid partition */
+#define MCM_ERROR_RANK        -2     /* r = 0, r > n_spins, or r too large for the chosen engine */
+#define MCM_ERROR_BUFFER      -3     /* the buffer for the parts is too small */
+#define MCM_ERROR_INTERNAL    -4     /* unexpected error (e.g. memory allocation) */
+
+/* Histogram of the data (a view on arrays owned by the caller): */
+typedef struct {
+    const uint32_t *states;     /* sparse histogram: the observed states;  NULL for a dense histogram */
+    const uint32_t *counts;     /* sparse: counts[i] = number of times states[i] is observed;  dense: counts[s] for s = 0 to 2^n_spins - 1 */
+    size_t size;                /* number of elements of counts */
+    unsigned int n_spins;       /* number of spins (operators) of the data, at most 32 */
+} mcm_histogram;
+
+/* Search engines:
+ *   MCM_ENGINE_SUBSET_DP    exact, dynamic programming over the subsets (3^r steps), r <= 24;
+ *   MCM_ENGINE_EXHAUSTIVE   exact, all the Bell(r) MCMs of rank r (as Version 1), r <= 20;
+ *   MCM_ENGINE_ANYTIME      best MCM found within `time_budget` seconds (see MCM_Anytime), r <= n of data.h;
+ *   MCM_ENGINE_ANNEALING    simulated annealing (see MCM_GivenRank_r_Annealing), r <= n of data.h.
+ * The two exact engines copy the histogram once, restricted to the r first spins, to compute the LogE of all the 2^r ICCs;
+ * the two others copy it once into a sorted Kset. */
+typedef enum {
+    MCM_ENGINE_SUBSET_DP = 0,
+    MCM_ENGINE_EXHAUSTIVE = 1,
+    MCM_ENGINE_ANYTIME = 2,
+    MCM_ENGINE_ANNEALING = 3
+} mcm_engine;
+
+/* Fill a histogram view (nothing is copied): */
+int mcm_histogram_sparse(mcm_histogram *h, const uint32_t *states, const uint32_t *counts, size_t size, unsigned int n_spins);
+int mcm_histogram_dense(mcm_histogram *h, const uint32_t *counts, unsigned int n_spins);
+
+/* Best MCM of rank r:  the parts are written in parts[0 .. *n_parts - 1] (one bit per operator, as in map<uint32_t, uint32_t> Partition),
+ * with parts_capacity >= r;  *LogE = LogE of the best MCM (including the contribution of the n_spins - r non-modeled spins).
+ * time_budget is only used by MCM_ENGINE_ANYTIME. */
+int mcm_search(const mcm_histogram *h, unsigned int r, mcm_engine engine, double time_budget, uint32_t *parts, unsigned int parts_capacity, unsigned int *n_parts, double *LogE);
+
+/* LogE of the MCM with the parts parts[0 .. n_parts - 1] (disjoint, on the n_spins operators): */
+int mcm_logE(const mcm_histogram *h, const uint32_t *parts, unsigned int n_parts, double *LogE);
+
+/* Description of a return code: */
+const char *mcm_error_string(int code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef MCM_ENGINE_H
+#define MCM_ENGINE_H
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+
+#include "partition.h"
+#include "progress.h"
+#include "tiered_cache.h"
+
+using namespace std;
+
+/******************************************************************************/
+/*************************   SEARCH ENGINE   **********************************/
+/******************************************************************************/
+// Exhaustive searches for the best MCM (Versions 1, 2 and 3), with all their settings held by the engine instead of global variables
+// (see MCM_Engine.cpp); the free functions MCM_GivenRank_r, MCM_AllRank_SmallerThan_r_Ordered and MCM_AllRank_SmallerThan_r_nonOrdered
+// build an engine with the default settings below.
+// The same settings are taken by the other searches of the library (see library.h), instead of OUTPUT_directory and cout.
+// Several engines (or searches) can be used at the same time in different threads, provided that they do not print in the same files
+// (i.e. different output_directory, or print_files = false).
+// Rem: the number of spins n is still set at compilation (data.h), as the states are handled with bitset<n>.
+// data.h must be included before this file.
+
+struct MCM_Search_Config {
+    unsigned int r = n;                                  // rank of the MCMs (MCMs based on the r first elements of the basis)
+    bool print_bool = false;                             // print the LogE of all the MCMs compared (in the files "AllMCMs_...")
+    bool print_files = true;                             // print the files "BestMCM_..." and "AllMCMs_..." (false: no file at all)
+    string output_directory = OUTPUT_directory;          // folder of the output files
+    ostream *out = &cout;                                // messages of the searches (NULL: no message)
+    double progress_interval = Progress_Default_Interval();     // progress report (see Set_Progress_Report; <= 0: no report)
+    string progress_filename = Progress_Default_Filename();
+    size_t cache_memory = LogE_cache_memory;             // memory budget of the cache of the LogE of the ICCs (bytes)
+    Tiered_LogE_Cache *cache = NULL;                     // cache shared with other engines (same Kset, N and r); NULL: own cache
+};
+
+class MCM_Search_Engine {
+  public:
+    // *** The histogram `Kset` is not copied: it must not be destroyed or modified while the engine is used:
+    MCM_Search_Engine(const vector<pair<uint32_t, unsigned int>> &Kset_, unsigned int N_, MCM_Search_Config Config_ = MCM_Search_Config());
+
+    map<uint32_t, uint32_t> GivenRank_r(double *LogE_best);                     // Version 1
+    map<uint32_t, uint32_t> AllRank_SmallerThan_r_Ordered(double *LogE_best);   // Version 2
+    map<uint32_t, uint32_t> AllRank_SmallerThan_r_nonOrdered(double *LogE_best);   // Version 3
+
+    // *** LogE of an ICC, read in the cache of the engine if it is there (see tiered_cache.h), and computed otherwise:
+    double LogE_ICC(uint32_t Ai);
+    double LogE_MCM(const Partition_t &Partition);
+    double LogE_MCM(const Partition_t &Partition, double *LogE_Parts);     // also gives the LogE of each part (LogE_Parts[32])
+    double LogE_SubMCM(double LogE_MCM, const Partition_t &Partition, const double *LogE_Parts, unsigned int k);   // MCM without its part k
+
+    Tiered_Cache_Stats Cache_Stats() const  {  return LogE_ICC_cache.Stats();  }     // hits and misses of the cache
+
+    const MCM_Search_Config Config;
+
+  private:
+    const vector<pair<uint32_t, unsigned int>> &Kset;
+    unsigned int N;
+    unique_ptr<Tiered_LogE_Cache> Own_cache;      // if Config.cache = NULL
+    Tiered_LogE_Cache &LogE_ICC_cache;
+    vector<pair<uint32_t, unsigned int>> Kset_ICC, Buffer;      // buffers of the projection of Kset on an ICC
+    ostream Null_stream;        // used if Config.out = NULL (no stream buffer: nothing is printed)
+    ostream &out;
+
+    MCM_Search_Engine(const MCM_Search_Engine &);               // not copyable (the engine refers to its Kset and to its output stream)
+    MCM_Search_Engine &operator=(const MCM_Search_Engine &);
+};
+
+#endif
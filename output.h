@@ -0,0 +1,77 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+/******************************************************************************/
+/***************************   OUTPUT FILES   *********************************/
+/******************************************************************************/
+// Output files of the program (see Output.cpp), used as an fstream opened with ios::out:
+// ***   - the text is kept in a large buffer (Output_buffer_size), written to the file only when the buffer is full or when the file is closed;
+// ***     `endl` doesn't flush the file at each line;
+// ***   - the doubles written with the default format (no `fixed` or `scientific`, default precision 6) are written with
+// ***     the shortest number of digits that gives back exactly the same double when the file is read
+// ***     (Grisu algorithm with the exactness check of Grisu3, and snprintf in the rare cases where this check fails);
+// ***   - with Output_writer_thread = true, the full buffers are written by a second thread while the next buffer is filled.
+// The file is complete only after `close()` (or at the destruction of the Output_File).
+
+// *** Settings of the new Output_File (see Set_Output in Output.cpp; atomic, as they can be changed while other threads open files):
+extern atomic<size_t> Output_buffer_size;          // bytes (1 MB by default)
+extern atomic<bool> Output_writer_thread;          // false by default
+
+class Output_Buffer : public streambuf {
+  public:
+    Output_Buffer() : error(false) {}
+    ~Output_Buffer()  {  close();  }
+
+    bool open(const string &filename, bool append, bool writer_thread);
+    bool is_open() const  {  return fd >= 0;  }
+    bool close();                               // false if some text could not be written
+
+  protected:
+    int overflow(int c);
+    int sync()  {  return 0;  }                 // no flush at each `endl`: the buffer is written when it is full
+    streampos seekoff(streamoff off, ios_base::seekdir way, ios_base::openmode which);   // only tellp()
+
+  private:
+    int fd = -1;
+    atomic<bool> error;                         // also set by the writer thread
+    unsigned long long bytes_written = 0;       // bytes given to the file (or to the writer thread)
+    vector<char> Front, Back;                   // Front: filled by the stream; Back: written by the writer thread
+
+    // *** Writer thread:
+    thread Writer;
+    mutex Writer_mutex;
+    condition_variable Writer_cv;
+    size_t Back_size = 0;                       // > 0: Back must be written
+    bool Writer_stop = false;
+
+    bool Write_Front();
+    void Writer_Loop();
+
+    Output_Buffer(const Output_Buffer &);               // not copyable
+    Output_Buffer &operator=(const Output_Buffer &);
+};
+
+class Output_File : public ostream {
+  public:
+    Output_File();
+    explicit Output_File(const string &filename, ios_base::openmode mode = ios::out);
+
+    void open(const string &filename, ios_base::openmode mode = ios::out);
+    bool is_open() const  {  return Buffer.is_open();  }
+    void close();
+
+  private:
+    Output_Buffer Buffer;
+};
+
+#endif
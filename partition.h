@@ -0,0 +1,64 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <map>
+#include <bitset>
+
+using namespace std;
+
+/******************************************************************************/
+/*******************   COMPACT REPRESENTATION of a PARTITION   ****************/
+/******************************************************************************/
+// The parts of an MCM are stored in a fixed-size array: Part[k] = integer encoded on n bits, whose 1 indicate the basis elements
+// included in the part k (same encoding as the values of map<uint32_t, uint32_t> Partition), for 0 <= k < size;
+// a Partition_t is copied without any memory allocation (contrary to map<uint32_t, uint32_t>).
+// Rem: there are at most 32 parts, as the basis elements are encoded on 32 bits.
+
+struct Partition_t {
+    uint32_t Part[32];      // Part[k] = basis elements in the part k
+    unsigned int size = 0;  // number of parts
+};
+
+// *** Add the part Ai at the end of the partition:
+inline void Partition_Add(Partition_t &Partition, uint32_t Ai)
+{
+  Partition.Part[Partition.size] = Ai;
+  Partition.size++;
+}
+
+// *** Remove the part k (the following parts are shifted, so that their order is kept):
+inline void Partition_Erase(Partition_t &Partition, unsigned int k)
+{
+  if (k >= Partition.size)  {  return;  }
+  for (unsigned int i=k+1; i<Partition.size; i++)  {  Partition.Part[i-1] = Partition.Part[i];  }
+  Partition.size--;
+}
+
+// *** Number of basis elements in the partition:
+inline unsigned int Partition_Rank(const Partition_t &Partition)
+{
+  unsigned int rank = 0;
+  for (unsigned int k=0; k<Partition.size; k++)  {  rank += bitset<32>(Partition.Part[k]).count();  }
+  return rank;
+}
+
+/******************************************************************************/
+/*****************   CONVERSION from and to map<uint32_t, uint32_t>   *********/
+/******************************************************************************/
+// *** The parts are taken in the order of the keys of the map:
+inline Partition_t Partition_from_map(const map<uint32_t, uint32_t> &Partition_map)
+{
+  Partition_t Partition;
+  for (auto const& Part : Partition_map)  {  if (Partition.size < 32)  {  Partition_Add(Partition, Part.second);  }  }
+  return Partition;
+}
+
+// *** The part k is stored with the key k:
+inline map<uint32_t, uint32_t> Partition_to_map(const Partition_t &Partition)
+{
+  map<uint32_t, uint32_t> Partition_map;
+  for (unsigned int k=0; k<Partition.size; k++)  {  Partition_map[k] = Partition.Part[k];  }
+  return Partition_map;
+}
+
+#endif
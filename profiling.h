@@ -0,0 +1,64 @@
+#ifndef PROFILING_H
+#define PROFILING_H
+
+#include <string>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+/******************************************************************************/
+/****************************   PROFILING   ***********************************/
+/******************************************************************************/
+// Instrumentation of the main phases of a run (see Profiling.cpp):
+// ***   - Profile_Timer: scoped timer, which adds the time spent in its scope to the phase `phase`;
+// ***     for the hot kernels (the searches), the timer can also read the hardware counters (cycles, instructions, cache misses);
+// ***   - Profile_Count: counts events (ICC evaluations, cache hits, map allocations, bytes written).
+// Nothing is measured unless the profiling is turned on (with Set_Profiling, or with the environment variable MCM_PROFILE).
+
+enum Profile_Counter_ID {
+    PROF_ICC_EVALUATIONS,         // number of ICCs evaluated (LogE_ICC, LogL_ICC, ...)
+    PROF_CACHE_HITS,              // number of ICCs read in a cache instead of being evaluated
+    PROF_MAP_ALLOCATIONS,         // number of histograms stored in a map (Nset, Kset, Kset of an ICC)
+    PROF_BYTES_WRITTEN,           // number of bytes written in the output files
+    PROF_N_COUNTERS
+};
+
+extern bool Profiling_enabled;
+extern atomic<unsigned long long> Profile_Counters[PROF_N_COUNTERS];
+
+inline void Profile_Count(Profile_Counter_ID id, unsigned long long x = 1)
+{
+  if (Profiling_enabled)  {  Profile_Counters[id].fetch_add(x, memory_order_relaxed);  }
+}
+
+// *** Functions of Profiling.cpp used by the timer:
+bool Profile_HW_Start(int *HW_fd);                        // HW_fd[3]; returns false if the hardware counters are not used
+void Profile_HW_Stop(int *HW_fd, long long *HW_values);   // HW_values[3] = {cycles, instructions, cache misses}
+void Profile_Add_Time(const char *phase, double seconds, const long long *HW_values);
+
+struct Profile_Timer {
+    const char *phase;
+    bool HW;                    // true if the hardware counters are read
+    int HW_fd[3];               // files of the 3 counters
+    chrono::steady_clock::time_point start;
+
+    Profile_Timer(const char *phase_name, bool hot_kernel = false) : phase(phase_name), HW(false)
+    {
+      HW_fd[0] = HW_fd[1] = HW_fd[2] = -1;
+      if (!Profiling_enabled)  {  return;  }
+      if (hot_kernel)  {  HW = Profile_HW_Start(HW_fd);  }
+      start = chrono::steady_clock::now();
+    }
+
+    ~Profile_Timer()
+    {
+      long long HW_values[3] = {0, 0, 0};
+      if (HW)  {  Profile_HW_Stop(HW_fd, HW_values);  }
+      if (!Profiling_enabled)  {  return;  }
+      double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      Profile_Add_Time(phase, seconds, (HW) ? HW_values : NULL);
+    }
+};
+
+#endif
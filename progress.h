@@ -0,0 +1,33 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <string>
+#include <chrono>
+
+using namespace std;
+
+/******************************************************************************/
+/*********************   PROGRESS of a LONG SEARCH   **************************/
+/******************************************************************************/
+// State of the progress report of one search (see Progress.cpp):
+// the search loops call Progress_Update() every (Progress_check_mask + 1) visited MCMs,
+// which only reads the clock, and reports if the time since the last report is larger than the chosen interval.
+
+const unsigned long long Progress_check_mask = (1ULL << 12) - 1;   // check the clock every 4096 MCMs
+
+// *** Default settings of the reports (see Set_Progress_Report in Progress.cpp),
+// *** read under a lock, as another thread can change them while a search starts:
+double Progress_Default_Interval();
+string Progress_Default_Filename();
+
+struct Search_Progress {
+    string name;                                        // name of the search function
+    double total = 0;                                   // number of MCMs to visit (e.g. Bell(r))
+    chrono::steady_clock::time_point start, last;       // start of the search, last report
+    unsigned int n_reports = 0;
+    bool active = false;
+    double interval = 0;                                // seconds between two reports
+    string filename = "";                               // if not empty, the reports are written in this file instead of the standard error
+};
+
+#endif
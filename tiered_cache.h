@@ -0,0 +1,68 @@
+#ifndef TIERED_CACHE_H
+#define TIERED_CACHE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/******************************************************************************/
+/*********************   CACHE of the LogE of the ICCs   **********************/
+/******************************************************************************/
+// LogE of the ICCs of the r first basis elements, stored within a memory budget (see Tiered_Cache.cpp):
+// ***   - dense tier:  one value for every part with at most k elements (k is the largest value that fits in half of the budget;
+// ***                  k = r if the 2^r values fit in the whole budget, and then there is no hash tier);
+// ***   - hash tier:   the larger parts, in a hash table of fixed size (buckets of 4 slots) that takes the rest of the budget;
+// ***                  when a bucket is full, a new part replaces one of its 4 parts (in turn), which will be computed again if needed.
+// Several threads can use the same cache at the same time (the buckets are protected by locks, the values of the dense tier are atomic).
+
+// *** Default memory budget of the caches, in bytes (1 GB; atomic, as it can be changed while other threads create caches):
+extern atomic<size_t> LogE_cache_memory;
+
+struct Tiered_Cache_Stats {
+    unsigned long long hits_dense = 0, hits_hash = 0, misses = 0, evictions = 0;
+    unsigned int k = 0;                      // the parts with at most k elements are in the dense tier
+    size_t dense_size = 0, hash_slots = 0;   // number of values in each tier
+    size_t memory = 0;                       // memory used by the two tiers (bytes)
+};
+
+class Tiered_LogE_Cache {
+  public:
+    Tiered_LogE_Cache(unsigned int r, size_t memory_budget = LogE_cache_memory);
+
+    bool Find(uint32_t Ai, double *LogE);         // true if the LogE of Ai is in the cache (Ai is a part of the r first elements)
+    void Insert(uint32_t Ai, double LogE);
+    Tiered_Cache_Stats Stats() const;
+
+  private:
+    struct Slot {
+        uint32_t Ai;           // 0: empty slot
+        double LogE;
+    };
+    static const unsigned int Bucket_size = 4, N_locks = 256;
+
+    unsigned int r, k;
+    uint64_t Binomial[33][33];
+    size_t Dense_offset[34];                      // first index of the parts with m elements in the dense tier
+    size_t Dense_size;
+    unique_ptr<atomic<double>[]> Dense;           // NAN: not computed yet
+
+    unsigned int log2_buckets;
+    size_t N_buckets;
+    unique_ptr<Slot[]> Buckets;                   // N_buckets * Bucket_size slots
+    unique_ptr<uint8_t[]> Next_victim;
+    mutex Locks[N_locks];
+
+    atomic<unsigned long long> hits_dense, hits_hash, misses, evictions;
+
+    size_t Dense_Index(uint32_t Ai, unsigned int m) const;
+    size_t Bucket_Index(uint32_t Ai) const;
+
+    Tiered_LogE_Cache(const Tiered_LogE_Cache &);               // not copyable
+    Tiered_LogE_Cache &operator=(const Tiered_LogE_Cache &);
+};
+
+#endif